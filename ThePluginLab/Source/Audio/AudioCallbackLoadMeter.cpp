@@ -0,0 +1,288 @@
+#include "AudioCallbackLoadMeter.h"
+
+namespace
+{
+    // std::atomic<double> has no fetch_max before C++26
+    void storeIfGreater(std::atomic<double>& target, double value) noexcept
+    {
+        auto current = target.load(std::memory_order_relaxed);
+
+        while (value > current && ! target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        {
+        }
+    }
+}
+
+AudioCallbackLoadMeter::AudioCallbackLoadMeter()
+{
+    for (auto& bucket : histogram)
+        bucket.store(0);
+
+    for (auto& load : recentLoads)
+        load.store(0.0f);
+}
+
+void AudioCallbackLoadMeter::setCallbackToMeasure(juce::AudioIODeviceCallback* callback)
+{
+    const juce::ScopedLock sl(deviceLock);
+    auto* device = currentDevice.load();
+
+    // Prepare the new callback before the audio thread can see it
+    if (callback != nullptr && device != nullptr)
+        callback->audioDeviceAboutToStart(device);
+
+    auto* previousCallback = callbackToMeasure.exchange(callback);
+    waitForCallbacksInFlight();
+
+    // The audio thread has finished with it by now
+    if (previousCallback != nullptr && previousCallback != callback && device != nullptr)
+        previousCallback->audioDeviceStopped();
+}
+
+void AudioCallbackLoadMeter::waitForCallbacksInFlight() const
+{
+    // A callback finishes within one block, so this never waits long
+    while (numActiveCallbacks.load() > 0)
+        juce::Thread::yield();
+}
+
+//==============================================================================
+void AudioCallbackLoadMeter::audioDeviceIOCallbackWithContext(const float* const* inputChannelData,
+                                                              int numInputChannels,
+                                                              float* const* outputChannelData,
+                                                              int numOutputChannels,
+                                                              int numSamples,
+                                                              const juce::AudioIODeviceCallbackContext& context)
+{
+    // Counted before the pointer is read, so setCallbackToMeasure can tell when the old callback is free
+    numActiveCallbacks.fetch_add(1);
+    auto* callback = callbackToMeasure.load();
+
+    auto startMs = juce::Time::getMillisecondCounterHiRes();
+
+    if (callback != nullptr)
+    {
+        callback->audioDeviceIOCallbackWithContext(inputChannelData, numInputChannels,
+                                                   outputChannelData, numOutputChannels,
+                                                   numSamples, context);
+    }
+    else
+    {
+        for (int i = 0; i < numOutputChannels; ++i)
+            if (outputChannelData[i] != nullptr)
+                juce::FloatVectorOperations::clear(outputChannelData[i], numSamples);
+    }
+
+    auto endMs = juce::Time::getMillisecondCounterHiRes();
+    numActiveCallbacks.fetch_sub(1);
+
+    // The deadline follows the actual block size, which some drivers vary per callback
+    auto rate = sampleRate.load(std::memory_order_relaxed);
+
+    if (rate > 0.0 && numSamples > 0)
+        deadlineMs.store(1000.0 * numSamples / rate, std::memory_order_relaxed);
+
+    auto intervalMs = lastCallbackStartMs > 0.0 ? startMs - lastCallbackStartMs : 0.0;
+    lastCallbackStartMs = startMs;
+
+    recordCallback(endMs - startMs, intervalMs);
+}
+
+void AudioCallbackLoadMeter::audioDeviceAboutToStart(juce::AudioIODevice* device)
+{
+    sampleRate.store(device->getCurrentSampleRate());
+    blockSize.store(device->getCurrentBufferSizeSamples());
+
+    if (sampleRate.load() > 0.0)
+        deadlineMs.store(1000.0 * blockSize.load() / sampleRate.load());
+
+    xRunsAtStart.store(juce::jmax(0, device->getXRunCount()));
+    lastCallbackStartMs = 0.0;
+
+    const juce::ScopedLock sl(deviceLock);
+    currentDevice.store(device);
+
+    if (auto* callback = callbackToMeasure.load())
+        callback->audioDeviceAboutToStart(device);
+}
+
+void AudioCallbackLoadMeter::audioDeviceStopped()
+{
+    const juce::ScopedLock sl(deviceLock);
+    currentDevice.store(nullptr);
+
+    if (auto* callback = callbackToMeasure.load())
+        callback->audioDeviceStopped();
+}
+
+void AudioCallbackLoadMeter::audioDeviceError(const juce::String& errorMessage)
+{
+    // Some drivers report errors from the audio thread, so this mustn't lock either
+    numActiveCallbacks.fetch_add(1);
+
+    if (auto* callback = callbackToMeasure.load())
+        callback->audioDeviceError(errorMessage);
+
+    numActiveCallbacks.fetch_sub(1);
+}
+
+//==============================================================================
+void AudioCallbackLoadMeter::recordCallback(double elapsedMs, double intervalMs)
+{
+    if (resetRequested.exchange(false))
+        clearOnAudioThread();
+
+    auto deadline = deadlineMs.load(std::memory_order_relaxed);
+
+    if (deadline <= 0.0)
+        return;
+
+    auto load = elapsedMs / deadline;
+
+    lastLoad.store(load, std::memory_order_relaxed);
+    storeIfGreater(peakLoad, load);
+    numCallbacks.fetch_add(1, std::memory_order_relaxed);
+
+    if (elapsedMs > deadline)
+        numMissedDeadlines.fetch_add(1, std::memory_order_relaxed);
+
+    if (intervalMs > 0.0)
+    {
+        storeIfGreater(maxIntervalJitterMs, std::abs(intervalMs - deadline));
+
+        // A callback arriving more than a whole period late means the device ran dry in between
+        if (intervalMs > 2.0 * deadline)
+            numLateCallbacks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Retire the oldest entry once the history is full, then add the new one
+    auto& slot = recentLoads[(size_t) historyWritePosition];
+
+    if (historySize.load(std::memory_order_relaxed) == historyLength)
+        histogram[(size_t) getBucketForLoad(slot.load(std::memory_order_relaxed))].fetch_sub(1, std::memory_order_relaxed);
+    else
+        historySize.fetch_add(1, std::memory_order_relaxed);
+
+    slot.store((float) load, std::memory_order_relaxed);
+    histogram[(size_t) getBucketForLoad(load)].fetch_add(1, std::memory_order_relaxed);
+
+    historyWritePosition = (historyWritePosition + 1) % historyLength;
+}
+
+void AudioCallbackLoadMeter::clearOnAudioThread()
+{
+    for (auto& bucket : histogram)
+        bucket.store(0, std::memory_order_relaxed);
+
+    historySize.store(0, std::memory_order_relaxed);
+    historyWritePosition = 0;
+
+    lastLoad.store(0.0, std::memory_order_relaxed);
+    peakLoad.store(0.0, std::memory_order_relaxed);
+    maxIntervalJitterMs.store(0.0, std::memory_order_relaxed);
+    numCallbacks.store(0, std::memory_order_relaxed);
+    numMissedDeadlines.store(0, std::memory_order_relaxed);
+    numLateCallbacks.store(0, std::memory_order_relaxed);
+
+    if (auto* device = currentDevice.load())
+        xRunsAtStart.store(juce::jmax(0, device->getXRunCount()), std::memory_order_relaxed);
+}
+
+int AudioCallbackLoadMeter::getBucketForLoad(double load)
+{
+    return juce::jlimit(0, numHistogramBuckets - 1, (int) (load / histogramBucketWidth));
+}
+
+//==============================================================================
+AudioCallbackLoadMeter::Statistics AudioCallbackLoadMeter::getStatistics() const
+{
+    Statistics stats;
+    stats.sampleRate = sampleRate.load();
+    stats.blockSize = blockSize.load();
+    stats.deadlineMs = deadlineMs.load();
+    stats.lastLoad = lastLoad.load();
+    stats.peakLoad = peakLoad.load();
+    stats.maxIntervalJitterMs = maxIntervalJitterMs.load();
+    stats.numCallbacks = numCallbacks.load();
+    stats.numMissedDeadlines = numMissedDeadlines.load();
+    stats.numLateCallbacks = numLateCallbacks.load();
+
+    if (auto* device = currentDevice.load())
+        stats.numDeviceXRuns = juce::jmax(0, device->getXRunCount() - xRunsAtStart.load());
+
+    auto count = historySize.load();
+
+    if (count > 0)
+    {
+        double sum = 0.0;
+
+        for (int i = 0; i < count; ++i)
+            sum += recentLoads[(size_t) i].load(std::memory_order_relaxed);
+
+        stats.averageLoad = sum / count;
+    }
+
+    return stats;
+}
+
+std::array<int, AudioCallbackLoadMeter::numHistogramBuckets> AudioCallbackLoadMeter::getLoadHistogram() const
+{
+    std::array<int, numHistogramBuckets> result;
+
+    for (size_t i = 0; i < result.size(); ++i)
+        result[i] = juce::jmax(0, histogram[i].load(std::memory_order_relaxed));
+
+    return result;
+}
+
+int AudioCallbackLoadMeter::getTotalXRuns() const
+{
+    auto stats = getStatistics();
+
+    // Drivers that report xruns already count the late callbacks, so don't add them twice
+    return stats.numMissedDeadlines + juce::jmax(stats.numLateCallbacks, stats.numDeviceXRuns);
+}
+
+void AudioCallbackLoadMeter::reset()
+{
+    resetRequested.store(true);
+}
+
+//==============================================================================
+juce::String AudioCallbackLoadMeter::createCSVReport() const
+{
+    auto stats = getStatistics();
+    auto buckets = getLoadHistogram();
+
+    juce::String csv;
+    csv << "metric,value" << juce::newLine
+        << "timestamp," << juce::Time::getCurrentTime().toISO8601(true) << juce::newLine
+        << "sample_rate," << stats.sampleRate << juce::newLine
+        << "block_size," << stats.blockSize << juce::newLine
+        << "deadline_ms," << stats.deadlineMs << juce::newLine
+        << "callbacks," << stats.numCallbacks << juce::newLine
+        << "average_load," << stats.averageLoad << juce::newLine
+        << "peak_load," << stats.peakLoad << juce::newLine
+        << "max_interval_jitter_ms," << stats.maxIntervalJitterMs << juce::newLine
+        << "missed_deadlines," << stats.numMissedDeadlines << juce::newLine
+        << "late_callbacks," << stats.numLateCallbacks << juce::newLine
+        << "device_xruns," << stats.numDeviceXRuns << juce::newLine
+        << juce::newLine
+        << "load_from_percent,load_to_percent,callbacks" << juce::newLine;
+
+    for (int i = 0; i < numHistogramBuckets; ++i)
+    {
+        auto from = juce::roundToInt(i * histogramBucketWidth * 100.0);
+        auto to = i == numHistogramBuckets - 1 ? juce::String("inf")
+                                               : juce::String(juce::roundToInt((i + 1) * histogramBucketWidth * 100.0));
+
+        csv << from << "," << to << "," << buckets[(size_t) i] << juce::newLine;
+    }
+
+    return csv;
+}
+
+bool AudioCallbackLoadMeter::exportCSV(const juce::File& file) const
+{
+    return file.replaceWithText(createCSVReport());
+}
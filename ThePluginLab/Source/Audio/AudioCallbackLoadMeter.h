@@ -0,0 +1,113 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+/**
+ * Device callback wrapper that times every audio callback against its
+ * deadline (numSamples / sampleRate) and counts missed deadlines.
+ *
+ * Register it with the AudioDeviceManager in place of the real callback and
+ * point it at the callback to measure. The UI can poll the counters and the
+ * rolling load histogram at any time without taking a lock, and the audio
+ * callback never takes one either, so a lock can't show up in the timings.
+ */
+class AudioCallbackLoadMeter : public juce::AudioIODeviceCallback
+{
+public:
+    // Load histogram covers 0-200% of the deadline in 5% buckets; the last bucket also catches anything above
+    static constexpr int numHistogramBuckets = 41;
+    static constexpr double histogramBucketWidth = 0.05;
+
+    // Number of recent callbacks the rolling histogram covers
+    static constexpr int historyLength = 4096;
+
+    AudioCallbackLoadMeter();
+    ~AudioCallbackLoadMeter() override = default;
+
+    // Callback being measured. May be changed while the device is running: as with
+    // AudioDeviceManager, the new callback is started before it's swapped in and the
+    // old one is stopped after it's swapped out, so once this returns the old
+    // callback is no longer in use and can be deleted. Call from the message thread.
+    void setCallbackToMeasure(juce::AudioIODeviceCallback* callback);
+
+    // AudioIODeviceCallback
+    void audioDeviceIOCallbackWithContext(const float* const* inputChannelData,
+                                          int numInputChannels,
+                                          float* const* outputChannelData,
+                                          int numOutputChannels,
+                                          int numSamples,
+                                          const juce::AudioIODeviceCallbackContext& context) override;
+    void audioDeviceAboutToStart(juce::AudioIODevice* device) override;
+    void audioDeviceStopped() override;
+    void audioDeviceError(const juce::String& errorMessage) override;
+
+    struct Statistics
+    {
+        double sampleRate = 0.0;
+        int blockSize = 0;
+        double deadlineMs = 0.0;
+        double lastLoad = 0.0;          // Fraction of the deadline used by the last callback
+        double peakLoad = 0.0;
+        double averageLoad = 0.0;       // Over the rolling history
+        double maxIntervalJitterMs = 0.0;
+        juce::int64 numCallbacks = 0;
+        int numMissedDeadlines = 0;     // Callbacks that took longer than their deadline
+        int numLateCallbacks = 0;       // Callbacks that arrived more than one deadline late
+        int numDeviceXRuns = 0;         // As reported by the driver, where supported
+    };
+
+    // Lock-free snapshot - safe to call from the message thread
+    Statistics getStatistics() const;
+    std::array<int, numHistogramBuckets> getLoadHistogram() const;
+    int getTotalXRuns() const;
+
+    // Clears counters and history. Takes effect on the next callback.
+    void reset();
+
+    // CSV export for capacity planning
+    juce::String createCSVReport() const;
+    bool exportCSV(const juce::File& file) const;
+
+private:
+    void recordCallback(double elapsedMs, double intervalMs);
+    static int getBucketForLoad(double load);
+
+    // Waits until no audio callback can still be holding a callback swapped out before the call
+    void waitForCallbacksInFlight() const;
+
+    // Swapped atomically; callbacks in flight are counted so the old one is known to be free
+    std::atomic<juce::AudioIODeviceCallback*> callbackToMeasure { nullptr };
+    std::atomic<int> numActiveCallbacks { 0 };
+
+    // Serialises setCallbackToMeasure with the device starting and stopping - never taken by the audio callback
+    juce::CriticalSection deviceLock;
+    std::atomic<juce::AudioIODevice*> currentDevice { nullptr };
+
+    std::atomic<double> sampleRate { 0.0 };
+    std::atomic<int> blockSize { 0 };
+    std::atomic<double> deadlineMs { 0.0 };
+    std::atomic<double> lastLoad { 0.0 };
+    std::atomic<double> peakLoad { 0.0 };
+    std::atomic<double> maxIntervalJitterMs { 0.0 };
+    std::atomic<juce::int64> numCallbacks { 0 };
+    std::atomic<int> numMissedDeadlines { 0 };
+    std::atomic<int> numLateCallbacks { 0 };
+    std::atomic<int> xRunsAtStart { 0 };
+
+    // Rolling histogram - each callback adds to its bucket and retires the
+    // load recorded historyLength callbacks ago
+    std::array<std::atomic<int>, numHistogramBuckets> histogram;
+    std::array<std::atomic<float>, historyLength> recentLoads;
+    std::atomic<int> historySize { 0 };
+
+    // Resets are carried out by the audio thread so the counters have a single writer
+    std::atomic<bool> resetRequested { false };
+
+    // Audio thread only
+    void clearOnAudioThread();
+    int historyWritePosition = 0;
+    double lastCallbackStartMs = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioCallbackLoadMeter)
+};
@@ -0,0 +1,104 @@
+#include "AudioGraphPlayer.h"
+#include "AudioProcessingGraph.h"
+
+void AudioGraphPlayer::setGraph(AudioProcessingGraph* graphToPlay)
+{
+    const juce::ScopedLock sl(deviceLock);
+
+    // Prepare the new graph before the audio thread can reach it
+    if (graphToPlay != nullptr && sampleRate > 0.0)
+        graphToPlay->prepareToPlay(sampleRate, blockSize);
+
+    auto* previousGraph = graph.exchange(graphToPlay);
+    waitForCallbacksInFlight();
+
+    if (previousGraph != nullptr && previousGraph != graphToPlay && sampleRate > 0.0)
+        previousGraph->releaseResources();
+}
+
+void AudioGraphPlayer::waitForCallbacksInFlight() const
+{
+    // A callback finishes within one block, so this never waits long
+    while (numActiveCallbacks.load() > 0)
+        juce::Thread::yield();
+}
+
+void AudioGraphPlayer::audioDeviceIOCallbackWithContext(const float* const* inputChannelData,
+                                                        int numInputChannels,
+                                                        float* const* outputChannelData,
+                                                        int numOutputChannels,
+                                                        int numSamples,
+                                                        const juce::AudioIODeviceCallbackContext&)
+{
+    // Counted before the pointer is read, so setGraph can tell when the old graph is free
+    numActiveCallbacks.fetch_add(1);
+    auto* graphToRender = graph.load();
+
+    // Some drivers deliver more than they announced; never resize here
+    if (graphToRender == nullptr || numSamples > buffer.getNumSamples())
+    {
+        for (int ch = 0; ch < numOutputChannels; ++ch)
+            if (outputChannelData[ch] != nullptr)
+                juce::FloatVectorOperations::clear(outputChannelData[ch], numSamples);
+
+        numActiveCallbacks.fetch_sub(1);
+        return;
+    }
+
+    juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), numSamples);
+
+    for (int ch = 0; ch < block.getNumChannels(); ++ch)
+    {
+        if (ch < numInputChannels && inputChannelData[ch] != nullptr)
+            block.copyFrom(ch, 0, inputChannelData[ch], numSamples);
+        else
+            block.clear(ch, 0, numSamples);
+    }
+
+    midi.clear();
+    graphToRender->processBlock(block, midi);
+
+    for (int ch = 0; ch < numOutputChannels; ++ch)
+    {
+        if (outputChannelData[ch] == nullptr)
+            continue;
+
+        if (ch < block.getNumChannels())
+            juce::FloatVectorOperations::copy(outputChannelData[ch], block.getReadPointer(ch), numSamples);
+        else
+            juce::FloatVectorOperations::clear(outputChannelData[ch], numSamples);
+    }
+
+    numActiveCallbacks.fetch_sub(1);
+}
+
+void AudioGraphPlayer::audioDeviceAboutToStart(juce::AudioIODevice* device)
+{
+    const auto numChannels = juce::jmax(2,
+                                        device->getActiveInputChannels().countNumberOfSetBits(),
+                                        device->getActiveOutputChannels().countNumberOfSetBits());
+
+    // Called before the device's callbacks start, so the audio-thread buffers are free to resize.
+    // Preparing the graph is quick: it calibrates later, on the message thread.
+    const juce::ScopedLock sl(deviceLock);
+
+    sampleRate = device->getCurrentSampleRate();
+    blockSize = device->getCurrentBufferSizeSamples();
+
+    buffer.setSize(numChannels, blockSize);
+    midi.ensureSize(2048);
+
+    if (auto* graphToPrepare = graph.load())
+        graphToPrepare->prepareToPlay(sampleRate, blockSize);
+}
+
+void AudioGraphPlayer::audioDeviceStopped()
+{
+    const juce::ScopedLock sl(deviceLock);
+
+    if (auto* graphToRelease = graph.load())
+        graphToRelease->releaseResources();
+
+    sampleRate = 0.0;
+    blockSize = 0;
+}
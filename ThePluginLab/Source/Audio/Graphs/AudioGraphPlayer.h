@@ -0,0 +1,54 @@
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+
+class AudioProcessingGraph;
+
+/**
+ * Plays an AudioProcessingGraph through an audio device.
+ *
+ * The device's input channels are copied into a preallocated buffer, the graph
+ * renders it in place and the result is written to the outputs, so nothing is
+ * allocated on the audio thread. Outputs are silent while no graph is set.
+ *
+ * The audio callback never takes a lock: the graph is handed over through an
+ * atomic pointer, and setGraph waits for any callback still using the old one.
+ */
+class AudioGraphPlayer : public juce::AudioIODeviceCallback
+{
+public:
+    AudioGraphPlayer() = default;
+    ~AudioGraphPlayer() override = default;
+
+    // The graph must outlive the player, or be replaced before it is deleted. Once
+    // this returns the audio thread no longer uses the previous graph.
+    void setGraph(AudioProcessingGraph* graphToPlay);
+
+    // AudioIODeviceCallback
+    void audioDeviceIOCallbackWithContext(const float* const* inputChannelData,
+                                          int numInputChannels,
+                                          float* const* outputChannelData,
+                                          int numOutputChannels,
+                                          int numSamples,
+                                          const juce::AudioIODeviceCallbackContext& context) override;
+    void audioDeviceAboutToStart(juce::AudioIODevice* device) override;
+    void audioDeviceStopped() override;
+
+private:
+    // Waits until no audio callback can still be holding a graph swapped out before the call
+    void waitForCallbacksInFlight() const;
+
+    std::atomic<AudioProcessingGraph*> graph { nullptr };
+    std::atomic<int> numActiveCallbacks { 0 };
+
+    // Serialises setGraph with the device starting and stopping - never taken by the audio callback
+    juce::CriticalSection deviceLock;
+    double sampleRate = 0.0;
+    int blockSize = 0;
+
+    // Audio thread only
+    juce::AudioBuffer<float> buffer;
+    juce::MidiBuffer midi;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioGraphPlayer)
+};
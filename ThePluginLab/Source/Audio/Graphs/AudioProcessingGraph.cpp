@@ -1,4 +1,6 @@
 #include "AudioProcessingGraph.h"
+#include "RealtimeSafetyAuditor.h"
+#include "DenormalProtection.h"
 
 // Add this proxy processor class that delegates to the real processor
 class ProcessorProxy : public juce::AudioProcessor
@@ -7,12 +9,23 @@ public:
     ProcessorProxy(juce::AudioProcessor* sourceProcessor) : source(sourceProcessor)
     {
         jassert(source != nullptr);
+        
+        // Cache the name here so the audio thread never has to build a String
+        if (source != nullptr)
+            sourceName = source->getName();
     }
     
     // Forward essential methods to the source processor
     void prepareToPlay(double sampleRate, int maxBlockSize) override
     {
-        if (source) source->prepareToPlay(sampleRate, maxBlockSize);
+        if (source)
+        {
+            // The graph sets the proxy's precision; the real processor must match it
+            if (source->supportsDoublePrecisionProcessing())
+                source->setProcessingPrecision(getProcessingPrecision());
+            
+            source->prepareToPlay(sampleRate, maxBlockSize);
+        }
     }
     
     void releaseResources() override
@@ -20,11 +33,36 @@ public:
         if (source) source->releaseResources();
     }
     
+    // The graph resets its nodes after calibration; the real processor holds the state
+    void reset() override
+    {
+        if (source) source->reset();
+    }
+    
     void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) override
     {
+        // Attribute any non-real-time-safe calls to this node in debug builds
+        RealtimeSafetyAuditor::ScopedAudit audit(sourceName.toRawUTF8());
+        
+        // Nodes may be rendered on any thread the graph uses, so set FTZ per node
+        juce::ScopedNoDenormals noDenormals;
+        
         if (source) source->processBlock(buffer, midiMessages);
     }
     
+    void processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages) override
+    {
+        RealtimeSafetyAuditor::ScopedAudit audit(sourceName.toRawUTF8());
+        juce::ScopedNoDenormals noDenormals;
+        
+        if (source) source->processBlock(buffer, midiMessages);
+    }
+    
+    bool supportsDoublePrecisionProcessing() const override
+    {
+        return source != nullptr && source->supportsDoublePrecisionProcessing();
+    }
+    
     // Required overrides
     const juce::String getName() const override { return source ? source->getName() : "Proxy"; }
     bool acceptsMidi() const override { return source ? source->acceptsMidi() : false; }
@@ -44,6 +82,7 @@ public:
     
 private:
     juce::AudioProcessor* source;
+    juce::String sourceName;
 };
 
 AudioProcessingGraph::AudioProcessingGraph()
@@ -55,9 +94,37 @@ AudioProcessingGraph::AudioProcessingGraph()
 AudioProcessingGraph::~AudioProcessingGraph()
 {
     // Clean up resources
+    cancelPendingUpdate();
     clear();
 }
 
+AudioProcessingGraph::ScopedRenderSuspension::ScopedRenderSuspension(AudioProcessingGraph& graphToSuspend)
+    : graph(graphToSuspend)
+{
+    graph.numRenderSuspensions.fetch_add(1);
+    
+    // A render already under way finishes within one block
+    while (graph.numActiveRenders.load() > 0)
+        juce::Thread::yield();
+}
+
+AudioProcessingGraph::ScopedRenderSuspension::~ScopedRenderSuspension()
+{
+    graph.numRenderSuspensions.fetch_sub(1);
+}
+
+void AudioProcessingGraph::topologyChanged()
+{
+    // The new nodes change both the fastest sub-block size and the usable precision
+    if (isPrepared.load())
+        triggerAsyncUpdate();
+}
+
+void AudioProcessingGraph::handleAsyncUpdate()
+{
+    calibrateSubBlockSize();
+}
+
 bool AudioProcessingGraph::connectProcessors(juce::AudioProcessor* sourceProcessor, int sourceChannel,
                                       juce::AudioProcessor* destProcessor, int destChannel)
 {
@@ -81,7 +148,12 @@ bool AudioProcessingGraph::connectProcessors(juce::AudioProcessor* sourceProcess
     dest.channelIndex = static_cast<juce::uint32>(destChannel);
     
     // Now create the connection
-    return audioGraph->addConnection({ source, dest });
+    const bool connected = audioGraph->addConnection({ source, dest });
+    
+    if (connected)
+        topologyChanged();
+        
+    return connected;
 }
 
 bool AudioProcessingGraph::disconnectProcessors(juce::AudioProcessor* sourceProcessor, int sourceChannel,
@@ -107,7 +179,12 @@ bool AudioProcessingGraph::disconnectProcessors(juce::AudioProcessor* sourceProc
     dest.channelIndex = static_cast<juce::uint32>(destChannel);
     
     // Remove the connection
-    return audioGraph->removeConnection({ source, dest });
+    const bool disconnected = audioGraph->removeConnection({ source, dest });
+    
+    if (disconnected)
+        topologyChanged();
+        
+    return disconnected;
 }
 
 // Fix the createNodeWithoutOwnership method:
@@ -119,6 +196,9 @@ juce::AudioProcessorGraph::Node::Ptr AudioProcessingGraph::createNodeWithoutOwne
     // Store the relationship between proxy and real processor
     auto node = audioGraph->addNode(std::move(proxy), nodeID);
     
+    if (node != nullptr)
+        topologyChanged();
+        
     return node;
 }
 
@@ -159,6 +239,7 @@ void AudioProcessingGraph::removeNode(juce::AudioProcessor* processor)
     {
         audioGraph->removeNode(node->nodeID);
         processors.removeFirstMatchingValue(processor);
+        topologyChanged();
     }
 }
 
@@ -214,6 +295,7 @@ void AudioProcessingGraph::clear()
         audioGraph->clear();
         processors.clear();
         nodeProcessorMap.clear();
+        topologyChanged();
     }
 }
 
@@ -251,7 +333,12 @@ bool AudioProcessingGraph::connectNodes(int sourceNodeId, int sourceChannelIndex
     dest.nodeID = juce::AudioProcessorGraph::NodeID(destNodeId);
     dest.channelIndex = static_cast<juce::uint32>(destChannelIndex);
     
-    return audioGraph->addConnection({ source, dest });
+    const bool connected = audioGraph->addConnection({ source, dest });
+    
+    if (connected)
+        topologyChanged();
+        
+    return connected;
 }
 
 void AudioProcessingGraph::disconnectNodes(int sourceNodeId, int destNodeId)
@@ -259,31 +346,289 @@ void AudioProcessingGraph::disconnectNodes(int sourceNodeId, int destNodeId)
     if (audioGraph == nullptr)
         return;
         
-    audioGraph->disconnectNode(juce::AudioProcessorGraph::NodeID(sourceNodeId));
+    if (audioGraph->disconnectNode(juce::AudioProcessorGraph::NodeID(sourceNodeId)))
+        topologyChanged();
 }
 
 void AudioProcessingGraph::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
+    const juce::ScopedLock sl(prepareLock);
+    const ScopedRenderSuspension suspension(*this);
+    
     currentSampleRate = sampleRate;
     currentBlockSize = samplesPerBlock;
     
+    // Reserve enough MIDI space for a busy block up front
+    subBlockMidiIn.ensureSize(2048);
+    subBlockMidiOut.ensureSize(2048);
+    
     if (audioGraph != nullptr)
     {
-        audioGraph->setPlayConfigDetails(2, 2, sampleRate, samplesPerBlock);
-        audioGraph->prepareToPlay(sampleRate, samplesPerBlock);
+        subBlockSize = juce::jmin(defaultSubBlockSize, currentBlockSize);
+        prepareGraph(subBlockSize);
+        isPrepared = true;
+        
+        // Timing the candidates renders noise through every node, so it's done on the
+        // message thread rather than holding up the device's start
+        triggerAsyncUpdate();
     }
 }
 
+void AudioProcessingGraph::prepareGraph(int internalBlockSize)
+{
+    // Double precision is only used when every node can render it natively. Called
+    // again whenever the nodes change, so this always reflects the current graph.
+    const bool useDoublePrecision = canUseDoublePrecision();
+    audioGraph->setProcessingPrecision(useDoublePrecision ? juce::AudioProcessor::doublePrecision
+                                                          : juce::AudioProcessor::singlePrecision);
+    
+    // Scratch buffer for converting blocks whose precision differs from the graph's
+    floatConversionBuffer.setSize(2, useDoublePrecision ? 0 : internalBlockSize, false, false, true);
+    doubleConversionBuffer.setSize(2, useDoublePrecision ? internalBlockSize : 0, false, false, true);
+    
+    audioGraph->setPlayConfigDetails(2, 2, currentSampleRate, internalBlockSize);
+    audioGraph->prepareToPlay(currentSampleRate, internalBlockSize);
+}
+
+int AudioProcessingGraph::calibrateSubBlockSize()
+{
+    const juce::ScopedLock sl(prepareLock);
+    
+    if (audioGraph == nullptr || ! isPrepared.load())
+        return subBlockSize;
+        
+    // The audio thread renders silence until the graph is prepared again
+    const ScopedRenderSuspension suspension(*this);
+    
+    // Splitting only pays off when the host block is larger than a candidate
+    if (audioGraph->getNumNodes() == 0 || currentBlockSize <= subBlockSizeCandidates[0])
+    {
+        subBlockSize = juce::jmin(defaultSubBlockSize, currentBlockSize);
+        prepareGraph(subBlockSize);
+        return subBlockSize;
+    }
+    
+    // Render a few host-sized blocks of noise at each candidate size and keep the fastest
+    const int numChannels = juce::jmax(2, audioGraph->getTotalNumInputChannels(), audioGraph->getTotalNumOutputChannels());
+    const int numPasses = 8;
+    
+    // Calibrate in the precision the graph will actually render in
+    juce::AudioBuffer<float> floatTestBuffer(numChannels, canUseDoublePrecision() ? 0 : currentBlockSize);
+    juce::AudioBuffer<double> doubleTestBuffer(numChannels, canUseDoublePrecision() ? currentBlockSize : 0);
+    juce::MidiBuffer testMidi;
+    juce::Random random(0x504c);
+    
+    auto timeNoiseBlock = [&](auto& testBuffer)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < currentBlockSize; ++i)
+                testBuffer.setSample(ch, i, random.nextFloat() * 0.5f - 0.25f);
+        
+        testMidi.clear();
+        
+        auto start = juce::Time::getMillisecondCounterHiRes();
+        processInSubBlocks(testBuffer, testMidi);
+        return juce::Time::getMillisecondCounterHiRes() - start;
+    };
+    
+    auto bestSize = defaultSubBlockSize;
+    auto bestTime = std::numeric_limits<double>::max();
+    
+    for (auto candidate : subBlockSizeCandidates)
+    {
+        if (candidate > currentBlockSize)
+            break;
+        
+        subBlockSize = candidate;
+        prepareGraph(subBlockSize);
+        
+        auto fastestPass = std::numeric_limits<double>::max();
+        
+        // The first pass warms caches and lazily-initialised node state
+        for (int pass = 0; pass <= numPasses; ++pass)
+        {
+            auto elapsed = audioGraph->isUsingDoublePrecision() ? timeNoiseBlock(doubleTestBuffer)
+                                                                : timeNoiseBlock(floatTestBuffer);
+            
+            if (pass > 0)
+                fastestPass = juce::jmin(fastestPass, elapsed);
+        }
+        
+        if (fastestPass < bestTime)
+        {
+            bestTime = fastestPass;
+            bestSize = candidate;
+        }
+    }
+    
+    subBlockSize = juce::jmin(bestSize, currentBlockSize);
+    prepareGraph(subBlockSize);
+    
+    // Don't let the calibration noise leak into delay lines, envelopes or meters.
+    // The proxies pass this on to the real processors.
+    audioGraph->reset();
+    
+    DBG("AudioProcessingGraph: using " << subBlockSize << "-sample sub-blocks for "
+        << currentBlockSize << "-sample host blocks");
+    
+    return subBlockSize;
+}
+
 void AudioProcessingGraph::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
-    if (audioGraph != nullptr)
+    numActiveRenders.fetch_add(1);
+    
+    if (audioGraph != nullptr && numRenderSuspensions.load() == 0)
     {
-        audioGraph->processBlock(buffer, midiMessages);
+        processInSubBlocks(buffer, midiMessages);
     }
+    else
+    {
+        // Being re-prepared - never wait for it on the audio thread
+        buffer.clear();
+        midiMessages.clear();
+    }
+    
+    numActiveRenders.fetch_sub(1);
+}
+
+void AudioProcessingGraph::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    numActiveRenders.fetch_add(1);
+    
+    if (audioGraph != nullptr && numRenderSuspensions.load() == 0)
+    {
+        processInSubBlocks(buffer, midiMessages);
+    }
+    else
+    {
+        buffer.clear();
+        midiMessages.clear();
+    }
+    
+    numActiveRenders.fetch_sub(1);
+}
+
+void AudioProcessingGraph::setDoublePrecisionEnabled(bool shouldUseDoublePrecision)
+{
+    if (doublePrecisionRequested == shouldUseDoublePrecision)
+        return;
+    
+    doublePrecisionRequested = shouldUseDoublePrecision;
+    
+    // Precision can only change while the graph is re-prepared. Never do that here,
+    // as the audio thread may be rendering - let the message thread suspend it first.
+    topologyChanged();
+}
+
+bool AudioProcessingGraph::canUseDoublePrecision() const
+{
+    if (! doublePrecisionRequested.load() || audioGraph == nullptr)
+        return false;
+    
+    for (auto* node : audioGraph->getNodes())
+        if (! node->getProcessor()->supportsDoublePrecisionProcessing())
+            return false;
+    
+    return true;
+}
+
+bool AudioProcessingGraph::isUsingDoublePrecision() const
+{
+    return audioGraph != nullptr && audioGraph->isUsingDoublePrecision();
+}
+
+template <typename SampleType>
+void AudioProcessingGraph::renderSubBlock(juce::AudioBuffer<SampleType>& subBlock, juce::MidiBuffer& midi)
+{
+    // Render in the graph's own precision, converting at the edge when the block differs
+    auto renderConverted = [&](auto& conversionBuffer)
+    {
+        using GraphType = std::remove_reference_t<decltype(*conversionBuffer.getWritePointer(0))>;
+        
+        const int numChannels = juce::jmin(subBlock.getNumChannels(), conversionBuffer.getNumChannels());
+        const int numSamples = subBlock.getNumSamples();
+        
+        juce::AudioBuffer<GraphType> graphBlock(conversionBuffer.getArrayOfWritePointers(), numChannels, numSamples);
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < numSamples; ++i)
+                graphBlock.setSample(ch, i, (GraphType) subBlock.getSample(ch, i));
+        
+        audioGraph->processBlock(graphBlock, midi);
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < numSamples; ++i)
+                subBlock.setSample(ch, i, (SampleType) graphBlock.getSample(ch, i));
+    };
+    
+    if constexpr (std::is_same_v<SampleType, double>)
+    {
+        // A node without a double path forced the graph to float
+        if (! audioGraph->isUsingDoublePrecision())
+        {
+            renderConverted(floatConversionBuffer);
+            return;
+        }
+    }
+    else
+    {
+        // Double precision was enabled, but the device delivers float
+        if (audioGraph->isUsingDoublePrecision())
+        {
+            renderConverted(doubleConversionBuffer);
+            return;
+        }
+    }
+    
+    audioGraph->processBlock(subBlock, midi);
+}
+
+template <typename SampleType>
+void AudioProcessingGraph::processInSubBlocks(juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages)
+{
+    // Flush denormals on this thread, or fall back to an offset where the CPU can't
+    DenormalProtection::ScopedRenderGuard denormalGuard;
+    denormalGuard.protect(buffer);
+    
+    const int numSamples = buffer.getNumSamples();
+    
+    if (numSamples <= subBlockSize)
+    {
+        renderSubBlock(buffer, midiMessages);
+        return;
+    }
+    
+    subBlockMidiOut.clear();
+    
+    for (int start = 0; start < numSamples; start += subBlockSize)
+    {
+        const int length = juce::jmin(subBlockSize, numSamples - start);
+        
+        // A view onto the host's channel data - no copying or allocation
+        juce::AudioBuffer<SampleType> subBlock(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, length);
+        
+        subBlockMidiIn.clear();
+        subBlockMidiIn.addEvents(midiMessages, start, length, -start);
+        
+        renderSubBlock(subBlock, subBlockMidiIn);
+        
+        subBlockMidiOut.addEvents(subBlockMidiIn, 0, length, start);
+    }
+    
+    // Copy rather than swap so the preallocated scratch buffer stays ours
+    midiMessages.clear();
+    midiMessages.addEvents(subBlockMidiOut, 0, numSamples, 0);
 }
 
 void AudioProcessingGraph::releaseResources()
 {
+    const juce::ScopedLock sl(prepareLock);
+    const ScopedRenderSuspension suspension(*this);
+    
+    isPrepared = false;
+    cancelPendingUpdate();
+    
     if (audioGraph != nullptr)
     {
         audioGraph->releaseResources();
@@ -9,23 +9,50 @@
 #include <map>
 #include <memory>
 #include <functional>
+#include <atomic>
 
 // Forward declarations
 class PluginNodeComponent;
 
 /**
  * Class for handling audio graph processing
+ *
+ * prepareToPlay and releaseResources may be called from the device's thread, and
+ * the graph can be re-prepared from the message thread while it is playing. While
+ * that happens the audio thread isn't made to wait: processBlock renders silence
+ * until the graph is ready again.
  */
-class AudioProcessingGraph
+class AudioProcessingGraph : private juce::AsyncUpdater
 {
 public:
     AudioProcessingGraph();
-    ~AudioProcessingGraph();
+    ~AudioProcessingGraph() override;
     
-    // Audio processing setup
+    // Audio processing setup. prepareToPlay starts at the default sub-block size and
+    // schedules calibrateSubBlockSize on the message thread.
     void prepareToPlay(double sampleRate, int samplesPerBlock);
     void releaseResources();
     void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages);
+    void processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages);
+    
+    // Opt-in double-precision rendering. The graph only renders in double when every
+    // node supports it; otherwise blocks are converted at the graph edge. The setting,
+    // and whether the nodes allow it, is applied whenever the graph is prepared: by the
+    // next prepareToPlay, or on the message thread shortly after a change while playing.
+    void setDoublePrecisionEnabled(bool shouldUseDoublePrecision);
+    bool isDoublePrecisionEnabled() const { return doublePrecisionRequested.load(); }
+    bool isUsingDoublePrecision() const;
+    
+    // Internal sub-block size - host blocks larger than this are split so each
+    // node's working set stays cache-resident
+    int getSubBlockSize() const { return subBlockSize; }
+    
+    // Times the current graph at each candidate sub-block size and picks the fastest,
+    // then resets every node so none of the test noise reaches real audio. Runs
+    // automatically on the message thread after prepareToPlay and whenever nodes or
+    // connections change; does nothing until the graph is prepared. Call from the
+    // message thread, where node telemetry is read. Returns the chosen size.
+    int calibrateSubBlockSize();
     
     // Graph management - basic methods
     void addNode(juce::AudioProcessor* processor);
@@ -58,9 +85,40 @@ private:
     // Helper methods
     juce::AudioProcessorGraph::Node* findNode(juce::AudioProcessor* processor);
     
+    // Re-prepares and re-calibrates on the message thread after the graph or its
+    // precision changes - the nodes decide whether double precision can be used
+    void topologyChanged();
+    void handleAsyncUpdate() override;
+    
+    // Keeps the audio thread out of the graph while it is being re-prepared
+    class ScopedRenderSuspension
+    {
+    public:
+        explicit ScopedRenderSuspension(AudioProcessingGraph& graphToSuspend);
+        ~ScopedRenderSuspension();
+        
+    private:
+        AudioProcessingGraph& graph;
+        JUCE_DECLARE_NON_COPYABLE(ScopedRenderSuspension)
+    };
+    
     // Method for adding processors that handles unique_ptr requirements
     juce::AudioProcessorGraph::Node::Ptr addProcessor(juce::AudioProcessor* processor);
     
+    // Prepares the graph for the given internal block size
+    void prepareGraph(int internalBlockSize);
+    
+    // Renders one block through the graph in sub-blocks of at most subBlockSize samples
+    template <typename SampleType>
+    void processInSubBlocks(juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages);
+    
+    // Renders one sub-block, converting to the graph's precision if needed
+    template <typename SampleType>
+    void renderSubBlock(juce::AudioBuffer<SampleType>& subBlock, juce::MidiBuffer& midi);
+    
+    // True when double precision was requested and every node supports it
+    bool canUseDoublePrecision() const;
+    
     // The JUCE audio processing graph
     std::unique_ptr<juce::AudioProcessorGraph> audioGraph;
     
@@ -68,6 +126,31 @@ private:
     double currentSampleRate = 44100.0;
     int currentBlockSize = 512;
     
+    // Candidate sub-block sizes tried during calibration
+    static constexpr int subBlockSizeCandidates[] = { 64, 128, 256 };
+    static constexpr int defaultSubBlockSize = 128;
+    
+    // Size the graph is actually prepared for - never larger than the host block
+    int subBlockSize = defaultSubBlockSize;
+    
+    // Serialises preparing, calibrating and releasing; never taken on the audio thread
+    juce::CriticalSection prepareLock;
+    std::atomic<bool> isPrepared { false };
+    
+    // processBlock only renders while no suspension is active, and the suspension
+    // waits for any render already in progress to finish
+    std::atomic<int> numRenderSuspensions { 0 };
+    std::atomic<int> numActiveRenders { 0 };
+    
+    // Preallocated MIDI scratch buffers so splitting never allocates on the audio thread
+    juce::MidiBuffer subBlockMidiIn;
+    juce::MidiBuffer subBlockMidiOut;
+    
+    // Precision state
+    std::atomic<bool> doublePrecisionRequested { false };
+    juce::AudioBuffer<float> floatConversionBuffer;
+    juce::AudioBuffer<double> doubleConversionBuffer;
+    
     // Track processors and nodes
     juce::Array<juce::AudioProcessor*> processors;
     juce::HashMap<PluginNodeComponent*, juce::AudioProcessor*> nodeProcessorMap;
@@ -0,0 +1,68 @@
+#pragma once
+#include <JuceHeader.h>
+
+/**
+ * Denormal protection for every thread that renders audio through the graph.
+ *
+ * ScopedRenderGuard sets flush-to-zero/denormals-are-zero for the duration of a
+ * render call. Worker threads that live for the whole session should call
+ * enableForCurrentThread() once when they start instead.
+ *
+ * On CPUs where FTZ/DAZ can't be set, the guard falls back to adding a tiny
+ * alternating offset (around -400 dBFS) to the block so that decaying filter
+ * and reverb tails settle on a normal number rather than drifting into the
+ * denormal range.
+ */
+class DenormalProtection
+{
+public:
+    class ScopedRenderGuard
+    {
+    public:
+        ScopedRenderGuard() noexcept
+            : flushToZeroActive(juce::FloatVectorOperations::areDenormalsDisabled())
+        {
+        }
+
+        // True when the hardware is flushing denormals on this thread
+        bool isFlushToZeroActive() const noexcept { return flushToZeroActive; }
+
+        // Applies the offset fallback when flush-to-zero isn't available
+        template <typename SampleType>
+        void protect(juce::AudioBuffer<SampleType>& buffer) const noexcept
+        {
+            if (! flushToZeroActive)
+                addAntiDenormalOffset(buffer);
+        }
+
+    private:
+        juce::ScopedNoDenormals noDenormals;
+        bool flushToZeroActive;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedRenderGuard)
+    };
+
+    // Call once at the start of a long-lived audio worker thread
+    static bool enableForCurrentThread() noexcept
+    {
+        juce::FloatVectorOperations::disableDenormalisedNumberSupport(true);
+        return juce::FloatVectorOperations::areDenormalsDisabled();
+    }
+
+    // Adds an inaudible offset that flips sign each block so it never accumulates as DC
+    template <typename SampleType>
+    static void addAntiDenormalOffset(juce::AudioBuffer<SampleType>& buffer) noexcept
+    {
+        static constexpr SampleType offsetMagnitude = (SampleType) 1.0e-20;
+        static thread_local bool positive = true;
+
+        const auto offset = positive ? offsetMagnitude : -offsetMagnitude;
+        positive = ! positive;
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            juce::FloatVectorOperations::add(buffer.getWritePointer(ch), offset, buffer.getNumSamples());
+    }
+
+private:
+    DenormalProtection() = delete;
+};
@@ -0,0 +1,577 @@
+#include "GraphDiagnostics.h"
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include "AudioProcessingGraph.h"
+#include "RealtimeSafetyAuditor.h"
+#include "../Processors/CompressorProcessor.h"
+#include "../Processors/PluginAudioProcessor.h"
+#include "../../Common/Helpers.h"
+
+namespace
+{
+    // Stereo in/out processor with the boilerplate filled in, for the diagnostic graphs
+    class DiagnosticProcessor : public juce::AudioProcessor
+    {
+    public:
+        explicit DiagnosticProcessor(const juce::String& nameToUse)
+            : AudioProcessor(BusesProperties()
+                                 .withInput("Input", juce::AudioChannelSet::stereo(), true)
+                                 .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
+              name(nameToUse)
+        {
+        }
+
+        void prepareToPlay(double, int) override {}
+        void releaseResources() override {}
+        void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override {}
+
+        const juce::String getName() const override { return name; }
+        bool acceptsMidi() const override { return false; }
+        bool producesMidi() const override { return false; }
+        double getTailLengthSeconds() const override { return 0.0; }
+        juce::AudioProcessorEditor* createEditor() override { return nullptr; }
+        bool hasEditor() const override { return false; }
+        int getNumPrograms() override { return 1; }
+        int getCurrentProgram() override { return 0; }
+        void setCurrentProgram(int) override {}
+        const juce::String getProgramName(int) override { return {}; }
+        void changeProgramName(int, const juce::String&) override {}
+        void getStateInformation(juce::MemoryBlock&) override {}
+        void setStateInformation(const void*, int) override {}
+
+    private:
+        juce::String name;
+    };
+
+    // Breaks the real-time rules on purpose: a fresh heap block every callback
+    class AllocatingProcessor : public DiagnosticProcessor
+    {
+    public:
+        AllocatingProcessor() : DiagnosticProcessor("RT check: allocating node") {}
+
+        void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) override
+        {
+            // Kept in a member so the allocation can't be optimised away
+            scratch.reset(new float[(size_t) juce::jmax(1, buffer.getNumSamples())]);
+            scratch[0] = buffer.getNumChannels() > 0 ? buffer.getSample(0, 0) : 0.0f;
+        }
+
+    private:
+        std::unique_ptr<float[]> scratch;
+    };
+
+    // Does all its work in place
+    class GainProcessor : public DiagnosticProcessor
+    {
+    public:
+        GainProcessor() : DiagnosticProcessor("RT check: clean node") {}
+
+        void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) override
+        {
+            buffer.applyGain(0.5f);
+        }
+    };
+
+    // Takes a lock every callback - uncontended, but still a call the audio thread mustn't make
+    class LockingProcessor : public DiagnosticProcessor
+    {
+    public:
+        LockingProcessor() : DiagnosticProcessor("RT check: locking node") {}
+
+        void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) override
+        {
+            const juce::ScopedLock sl(lock);
+            buffer.applyGain(1.0f);
+        }
+
+    private:
+        juce::CriticalSection lock;
+    };
+
+    // A slowly decaying feedback loop whose tail runs down into the denormal range unless flushed
+    class DecayingTailProcessor : public DiagnosticProcessor
+    {
+    public:
+        DecayingTailProcessor() : DiagnosticProcessor("Denormal check: decaying tail") {}
+
+        void prepareToPlay(double, int) override { reset(); }
+
+        void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) override
+        {
+            const int numChannels = juce::jmin(buffer.getNumChannels(), (int) state.size());
+            int subnormals = 0;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                auto* samples = buffer.getWritePointer(channel);
+                auto y = state[(size_t) channel];
+
+                for (int i = 0; i < buffer.getNumSamples(); ++i)
+                {
+                    y = feedback * y + samples[i];
+                    samples[i] = y;
+                    peakOutput = juce::jmax(peakOutput, std::abs(y));
+
+                    if (std::fpclassify(y) == FP_SUBNORMAL)
+                        ++subnormals;
+                }
+
+                state[(size_t) channel] = y;
+            }
+
+            subnormalSamples += subnormals;
+        }
+
+        void reset() override
+        {
+            state.fill(0.0f);
+            subnormalSamples = 0;
+            peakOutput = 0.0f;
+        }
+
+        int getNumSubnormalSamples() const noexcept { return subnormalSamples; }
+        float getPeakOutput() const noexcept { return peakOutput; }
+
+    private:
+        static constexpr float feedback = 0.999f;
+        std::array<float, 2> state {};
+        std::atomic<int> subnormalSamples { 0 };
+        float peakOutput = 0.0f;
+    };
+
+    // The graph has no audio input, so its run of the tail is excited from inside the graph
+    class ImpulseSourceProcessor : public DiagnosticProcessor
+    {
+    public:
+        ImpulseSourceProcessor() : DiagnosticProcessor("Denormal check: impulse source") {}
+
+        void prepareToPlay(double, int) override { reset(); }
+
+        void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) override
+        {
+            buffer.clear();
+
+            if (! impulseSent && buffer.getNumSamples() > 0)
+                for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                    buffer.setSample(channel, 0, 1.0f);
+
+            impulseSent = true;
+        }
+
+        void reset() override { impulseSent = false; }
+
+    private:
+        bool impulseSent = false;
+    };
+
+    // Feeds an impulse then silence, returning the mean time per block in microseconds
+    template <typename Renderer>
+    double renderImpulseTail(Renderer&& render, int numBlocks, int blockSize)
+    {
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        juce::MidiBuffer midi;
+        double totalMicroseconds = 0.0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            buffer.clear();
+
+            if (block == 0)
+                for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                    buffer.setSample(channel, 0, 1.0f);
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            render(buffer, midi);
+            totalMicroseconds += juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1.0e6;
+        }
+
+        return totalMicroseconds / juce::jmax(1, numBlocks);
+    }
+
+    // The graph has no audio input, so test signals are generated inside it
+    class NoiseSourceProcessor : public DiagnosticProcessor
+    {
+    public:
+        NoiseSourceProcessor() : DiagnosticProcessor("Precision check: noise source") {}
+
+        void prepareToPlay(double, int) override { reset(); }
+        void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) override { fill(buffer); }
+        void processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer&) override { fill(buffer); }
+        bool supportsDoublePrecisionProcessing() const override { return true; }
+
+        // Restarts the noise, so every run sees the same signal
+        void reset() override { random.setSeed(0x5eed); }
+
+    private:
+        // Loud enough to keep every compressor working
+        template <typename SampleType>
+        void fill(juce::AudioBuffer<SampleType>& buffer)
+        {
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                for (int i = 0; i < buffer.getNumSamples(); ++i)
+                    buffer.setSample(channel, i, (SampleType) (random.nextFloat() * 1.6f - 0.8f));
+        }
+
+        juce::Random random;
+    };
+
+    // Keeps the most recent host block reaching the end of a chain, however the graph splits it
+    class CaptureProcessor : public DiagnosticProcessor
+    {
+    public:
+        explicit CaptureProcessor(int hostBlockSize)
+            : DiagnosticProcessor("Precision check: capture"),
+              captured(2, hostBlockSize)
+        {
+        }
+
+        void prepareToPlay(double, int) override { reset(); }
+        void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) override { capture(buffer); }
+        void processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer&) override { capture(buffer); }
+        bool supportsDoublePrecisionProcessing() const override { return true; }
+
+        void reset() override
+        {
+            captured.clear();
+            writePosition = 0;
+        }
+
+        const juce::AudioBuffer<double>& getCaptured() const noexcept { return captured; }
+
+    private:
+        template <typename SampleType>
+        void capture(const juce::AudioBuffer<SampleType>& buffer)
+        {
+            const int numChannels = juce::jmin(buffer.getNumChannels(), captured.getNumChannels());
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                    captured.setSample(channel, writePosition, (double) buffer.getSample(channel, i));
+
+                writePosition = (writePosition + 1) % captured.getNumSamples();
+            }
+        }
+
+        juce::AudioBuffer<double> captured;
+        int writePosition = 0;
+    };
+
+    struct PrecisionRun
+    {
+        double meanMicroseconds = 0.0;
+        double maxMicroseconds = 0.0;
+        bool graphUsedDouble = false;
+        int subBlockSize = 0;
+        juce::AudioBuffer<double> lastBlock;
+    };
+
+    // Renders source -> numNodes processors -> capture through AudioProcessingGraph::processBlock
+    // with host blocks of SampleType, asking for double precision when the blocks are double
+    template <typename SampleType>
+    PrecisionRun timeGraphChain(const std::function<juce::AudioProcessor*()>& createNode,
+                                int numNodes, int numBlocks, double sampleRate, int blockSize)
+    {
+        NoiseSourceProcessor source;
+        CaptureProcessor capture(blockSize);
+        juce::OwnedArray<juce::AudioProcessor> chain;
+
+        AudioProcessingGraph graph;
+        graph.addNode(&source);
+        juce::AudioProcessor* previous = &source;
+
+        auto connectStereo = [&](juce::AudioProcessor* next)
+        {
+            graph.addNode(next);
+            graph.connectProcessors(previous, 0, next, 0);
+            graph.connectProcessors(previous, 1, next, 1);
+            previous = next;
+        };
+
+        for (int i = 0; i < numNodes; ++i)
+            connectStereo(chain.add(createNode()));
+
+        connectStereo(&capture);
+
+        // Calibrated as the player's graph would be, which also resets every node afterwards
+        graph.setDoublePrecisionEnabled(std::is_same_v<SampleType, double>);
+        graph.prepareToPlay(sampleRate, blockSize);
+
+        PrecisionRun run;
+        run.subBlockSize = graph.calibrateSubBlockSize();
+        run.graphUsedDouble = graph.isUsingDoublePrecision();
+
+        juce::AudioBuffer<SampleType> buffer(2, blockSize);
+        juce::MidiBuffer midi;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            buffer.clear();
+            midi.clear();
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            graph.processBlock(buffer, midi);
+
+            const auto elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1.0e6;
+            run.meanMicroseconds += elapsed;
+            run.maxMicroseconds = juce::jmax(run.maxMicroseconds, elapsed);
+        }
+
+        run.meanMicroseconds /= juce::jmax(1, numBlocks);
+        run.lastBlock.makeCopyOf(capture.getCaptured());
+
+        graph.releaseResources();
+        graph.clear();
+        return run;
+    }
+}
+
+bool GraphDiagnostics::handlesCommandLine(const juce::String& commandLine)
+{
+    return commandLine.contains("--check-rt-safety")
+        || commandLine.contains("--bench-graph-precision")
+        || commandLine.contains("--check-denormal-tail");
+}
+
+int GraphDiagnostics::runFromCommandLine(const juce::String& commandLine)
+{
+    juce::ArgumentList arguments("ThePluginLab", commandLine);
+    juce::String report;
+    bool passed = true;
+
+    if (arguments.containsOption("--check-rt-safety"))
+        passed = checkRealtimeSafety(report) && passed;
+
+    if (arguments.containsOption("--check-denormal-tail"))
+        passed = checkDenormalTail(report) && passed;
+
+    if (arguments.containsOption("--bench-graph-precision"))
+    {
+        const int numNodes = Helpers::getIntOption(arguments, "--nodes", 8);
+        const int numBlocks = Helpers::getIntOption(arguments, "--blocks", 2000);
+        passed = benchmarkPrecision(report, juce::jmax(1, numNodes), juce::jmax(1, numBlocks)) && passed;
+    }
+
+    std::cout << report << std::flush;
+    return passed ? 0 : 1;
+}
+
+bool GraphDiagnostics::checkRealtimeSafety(juce::String& report)
+{
+    report << "Real-time safety audit" << juce::newLine;
+
+   #if ! PLUGINLAB_RT_SAFETY_AUDIT
+    report << "  FAILED: the auditor isn't compiled into this build (set PLUGINLAB_RT_SAFETY_AUDIT=1)" << juce::newLine;
+    return false;
+   #else
+    constexpr int numBlocks = 16;
+    constexpr int blockSize = 512;
+
+    AllocatingProcessor allocating;
+    GainProcessor clean;
+    LockingProcessor locking;
+
+    AudioProcessingGraph graph;
+    graph.addNode(&allocating);
+    graph.addNode(&clean);
+    graph.addNode(&locking);
+    graph.prepareToPlay(48000.0, blockSize);
+
+    // Only count what happens while rendering, not during preparation
+    const auto previousMode = RealtimeSafetyAuditor::getMode();
+    RealtimeSafetyAuditor::setMode(RealtimeSafetyAuditor::Mode::Count);
+    RealtimeSafetyAuditor::reset();
+
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    juce::MidiBuffer midi;
+
+    for (int block = 0; block < numBlocks; ++block)
+    {
+        buffer.clear();
+        graph.processBlock(buffer, midi);
+    }
+
+    int allocatingViolations = 0, cleanViolations = 0, lockViolations = 0, otherViolations = 0;
+
+    for (const auto& violation : RealtimeSafetyAuditor::getViolations())
+    {
+        const juce::String nodeName(violation.nodeName);
+
+        if (nodeName == allocating.getName())
+            ++allocatingViolations;
+        else if (nodeName == clean.getName())
+            ++cleanViolations;
+        else if (nodeName == locking.getName() && violation.type == RealtimeSafetyAuditor::ViolationType::MutexLock)
+            ++lockViolations;
+        else
+            ++otherViolations;
+    }
+
+    report << RealtimeSafetyAuditor::getReport();
+
+    RealtimeSafetyAuditor::reset();
+    RealtimeSafetyAuditor::setMode(previousMode);
+    graph.releaseResources();
+    graph.clear();
+
+    // At least one allocation per rendered block, and nothing blamed on the clean node.
+    // Locks can only be caught where the lock hooks exist.
+    const bool canAuditLocks = RealtimeSafetyAuditor::canAuditLocksAndSystemCalls();
+    const bool locksCaught = canAuditLocks ? lockViolations >= numBlocks : lockViolations == 0;
+    const bool passed = allocatingViolations >= numBlocks && cleanViolations == 0 && otherViolations == 0 && locksCaught;
+
+    report << "  " << allocatingViolations << " on the allocating node over " << numBlocks << " blocks, "
+           << lockViolations << " locks on the locking node, "
+           << cleanViolations << " on the clean node, " << otherViolations << " elsewhere: "
+           << (passed ? "passed" : "FAILED") << juce::newLine;
+
+    if (! canAuditLocks)
+        report << "  note: only allocations are audited on this platform - the locking node's locks went unchecked" << juce::newLine;
+
+    return passed;
+   #endif
+}
+
+bool GraphDiagnostics::checkDenormalTail(juce::String& report)
+{
+    // 0.999^n falls below FLT_MIN after ~87k samples, so 256 blocks run well into the denormal range
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr int numBlocks = 256;
+
+    report << "Denormal protection on a decaying tail (" << numBlocks << " blocks of " << blockSize << ")" << juce::newLine;
+
+    DecayingTailProcessor tail;
+    tail.setPlayConfigDetails(2, 2, sampleRate, blockSize);
+
+    // Without protection, to show the tail really does go subnormal on this machine
+    const bool wereDenormalsDisabled = juce::FloatVectorOperations::areDenormalsDisabled();
+    juce::FloatVectorOperations::disableDenormalisedNumberSupport(false);
+
+    tail.prepareToPlay(sampleRate, blockSize);
+    const auto unprotectedMicroseconds = renderImpulseTail([&](juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midi)
+                                                           { tail.processBlock(buffer, midi); },
+                                                           numBlocks, blockSize);
+    const int unprotectedSubnormals = tail.getNumSubnormalSamples();
+
+    juce::FloatVectorOperations::disableDenormalisedNumberSupport(wereDenormalsDisabled);
+
+    // The same tail rendered through the graph, which should keep it out of the denormal range.
+    // The host buffer's impulse never reaches the nodes, so a source node supplies it.
+    ImpulseSourceProcessor impulse;
+    AudioProcessingGraph graph;
+    graph.addNode(&impulse);
+    graph.addNode(&tail);
+    graph.connectProcessors(&impulse, 0, &tail, 0);
+    graph.connectProcessors(&impulse, 1, &tail, 1);
+    graph.prepareToPlay(sampleRate, blockSize);
+    impulse.reset();
+    tail.reset();
+
+    const auto graphMicroseconds = renderImpulseTail([&](juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midi)
+                                                     { graph.processBlock(buffer, midi); },
+                                                     numBlocks, blockSize);
+    const int graphSubnormals = tail.getNumSubnormalSamples();
+
+    graph.releaseResources();
+    graph.clear();
+
+    report << "  unprotected: " << unprotectedSubnormals << " subnormal samples, "
+           << juce::String(unprotectedMicroseconds, 2) << " us/block mean" << juce::newLine
+           << "  through the graph: " << graphSubnormals << " subnormal samples, "
+           << juce::String(graphMicroseconds, 2) << " us/block mean" << juce::newLine;
+
+    if (unprotectedSubnormals == 0)
+        report << "  note: the unprotected run never went subnormal, so the comparison proves nothing here" << juce::newLine;
+
+    // A tail that never left zero would pass without testing anything
+    const bool tailExcited = tail.getPeakOutput() > 0.0f;
+
+    if (! tailExcited)
+        report << "  FAILED: the impulse never reached the tail node inside the graph" << juce::newLine;
+
+    const bool passed = tailExcited && graphSubnormals == 0;
+    report << "  " << (passed ? "passed" : "FAILED") << juce::newLine;
+    return passed;
+}
+
+bool GraphDiagnostics::benchmarkPrecision(juce::String& report, int numNodes, int numBlocks)
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    const double deadlineMicroseconds = blockSize / sampleRate * 1.0e6;
+
+    report << "Float vs double through the graph: " << numNodes << " nodes in series per type, "
+           << numBlocks << " blocks of " << blockSize << " at " << (int) sampleRate << " Hz" << juce::newLine;
+
+    struct ProcessorType
+    {
+        const char* name;
+        std::function<juce::AudioProcessor*()> create;
+        bool rendersDouble;
+    };
+
+    const ProcessorType types[] =
+    {
+        { "Compressor", []
+            {
+                auto* compressor = new CompressorProcessor();
+                compressor->setThreshold(-24.0f);
+                compressor->setRatio(4.0f);
+                compressor->setAttack(5.0f);
+                compressor->setRelease(100.0f);
+                return static_cast<juce::AudioProcessor*>(compressor);
+            }, true },
+        { "Pass-through", [] { return static_cast<juce::AudioProcessor*>(new PluginAudioProcessor()); }, false }
+    };
+
+    bool passed = true;
+
+    for (const auto& type : types)
+    {
+        const auto floatRun = timeGraphChain<float>(type.create, numNodes, numBlocks, sampleRate, blockSize);
+        const auto doubleRun = timeGraphChain<double>(type.create, numNodes, numBlocks, sampleRate, blockSize);
+
+        // How far the float chain drifted from the double one on the final block
+        double maxDifference = 0.0;
+
+        for (int channel = 0; channel < floatRun.lastBlock.getNumChannels(); ++channel)
+            for (int i = 0; i < floatRun.lastBlock.getNumSamples(); ++i)
+                maxDifference = juce::jmax(maxDifference, std::abs(floatRun.lastBlock.getSample(channel, i)
+                                                                   - doubleRun.lastBlock.getSample(channel, i)));
+
+        report << "  " << type.name << ":" << juce::newLine;
+
+        auto describe = [&](const char* label, const PrecisionRun& run)
+        {
+            report << "    " << label << juce::String(run.meanMicroseconds, 2) << " us/block mean, "
+                   << juce::String(run.maxMicroseconds, 2) << " us max, "
+                   << juce::String(100.0 * run.meanMicroseconds / deadlineMicroseconds, 3) << "% of the "
+                   << juce::String(deadlineMicroseconds, 0) << " us deadline, "
+                   << run.subBlockSize << "-sample sub-blocks, graph in "
+                   << (run.graphUsedDouble ? "double" : "float") << juce::newLine;
+        };
+
+        describe("float:  ", floatRun);
+        describe("double: ", doubleRun);
+
+        report << "    double/float: " << juce::String(doubleRun.meanMicroseconds / juce::jmax(1.0e-9, floatRun.meanMicroseconds), 2)
+               << "x, largest float vs double output difference "
+               << juce::String(juce::Decibels::gainToDecibels(maxDifference, -200.0), 1) << " dBFS" << juce::newLine;
+
+        // Double only when asked for and every node has a double path; otherwise converted at the edge
+        const bool precisionAsExpected = ! floatRun.graphUsedDouble && doubleRun.graphUsedDouble == type.rendersDouble;
+        passed = passed && precisionAsExpected;
+
+        report << "    graph precision: "
+               << (precisionAsExpected ? juce::String(type.rendersDouble ? "renders double when enabled"
+                                                                         : "stays float, double blocks converted at the edge")
+                                       : juce::String("FAILED - wrong precision chosen")) << juce::newLine;
+    }
+
+    return passed;
+}
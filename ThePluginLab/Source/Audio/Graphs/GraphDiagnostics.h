@@ -0,0 +1,48 @@
+#pragma once
+#include <JuceHeader.h>
+
+/**
+ * Headless checks for the audio graph, run from the command line and reported on stdout.
+ *
+ *   --check-rt-safety   Renders a graph holding one node that allocates on the audio
+ *                       thread, one that takes a lock and one that does neither, and
+ *                       fails unless the real-time safety auditor blames exactly the
+ *                       offending nodes. Locks are only audited on Linux, so elsewhere
+ *                       the report says the locking node went unchecked. Needs a
+ *                       build with PLUGINLAB_RT_SAFETY_AUDIT (debug by default).
+ *
+ *   --check-denormal-tail
+ *                       Feeds an impulse into a slowly decaying feedback node, first
+ *                       directly with denormals enabled and then through the graph,
+ *                       and fails if any sample rendered by the graph is subnormal,
+ *                       or if the impulse never reached the node inside the graph.
+ *                       Both runs are timed, showing what the protection saves.
+ *
+ *   --bench-graph-precision [--nodes N] [--blocks M]
+ *                       For each processor type, renders a chain of N nodes (default
+ *                       8) through AudioProcessingGraph::processBlock for M blocks
+ *                       (default 2000), once with float blocks and once with double
+ *                       precision enabled and double blocks. Reports the cost per
+ *                       block against the real-time deadline and how far the float
+ *                       output drifts, and fails if the graph renders double for a
+ *                       chain with a float-only node, or won't for one without.
+ *
+ * Like the visualizer render harness, nothing here needs a display or an audio device.
+ */
+class GraphDiagnostics
+{
+public:
+    // True if the command line asks for one of the checks above
+    static bool handlesCommandLine(const juce::String& commandLine);
+
+    // Runs the requested checks, prints their reports and returns the process exit code
+    static int runFromCommandLine(const juce::String& commandLine);
+
+    // Each check appends to the report and returns false if it failed
+    static bool checkRealtimeSafety(juce::String& report);
+    static bool checkDenormalTail(juce::String& report);
+    static bool benchmarkPrecision(juce::String& report, int numNodes, int numBlocks);
+
+private:
+    GraphDiagnostics() = delete;
+};
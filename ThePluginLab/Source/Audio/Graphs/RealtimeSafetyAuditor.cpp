@@ -0,0 +1,318 @@
+#include "RealtimeSafetyAuditor.h"
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <new>
+
+#if PLUGINLAB_RT_SAFETY_AUDIT && JUCE_LINUX
+ #include <dlfcn.h>
+ #include <pthread.h>
+ #include <time.h>
+ #include <unistd.h>
+#endif
+
+namespace
+{
+    // Fixed-size violation log so that recording never allocates
+    constexpr int maxRecordedViolations = 256;
+
+    RealtimeSafetyAuditor::Violation recordedViolations[maxRecordedViolations];
+    std::atomic<int> numViolations { 0 };
+    std::atomic<int> auditMode { static_cast<int>(RealtimeSafetyAuditor::Mode::Count) };
+
+    // Node currently rendering on this thread, or nullptr outside audited code
+    thread_local const char* currentNode = nullptr;
+
+    // Guards against re-entering the hooks from the auditor's own bookkeeping
+    thread_local bool insideHook = false;
+}
+
+//==============================================================================
+#if PLUGINLAB_RT_SAFETY_AUDIT
+RealtimeSafetyAuditor::ScopedAudit::ScopedAudit(const char* nodeName) noexcept
+    : previousNode(currentNode)
+{
+    currentNode = nodeName != nullptr ? nodeName : "Unnamed node";
+}
+
+RealtimeSafetyAuditor::ScopedAudit::~ScopedAudit() noexcept
+{
+    currentNode = previousNode;
+}
+#endif
+
+void RealtimeSafetyAuditor::setMode(Mode newMode) noexcept
+{
+    auditMode.store(static_cast<int>(newMode));
+}
+
+RealtimeSafetyAuditor::Mode RealtimeSafetyAuditor::getMode() noexcept
+{
+    return static_cast<Mode>(auditMode.load());
+}
+
+bool RealtimeSafetyAuditor::isAuditingCurrentThread() noexcept
+{
+    return currentNode != nullptr && ! insideHook;
+}
+
+bool RealtimeSafetyAuditor::canAuditLocksAndSystemCalls() noexcept
+{
+   #if PLUGINLAB_RT_SAFETY_AUDIT && JUCE_LINUX
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+void RealtimeSafetyAuditor::reportViolation(ViolationType type, const char* call) noexcept
+{
+    if (! isAuditingCurrentThread())
+        return;
+
+    insideHook = true;
+
+    auto index = numViolations.fetch_add(1);
+
+    if (index < maxRecordedViolations)
+    {
+        auto& violation = recordedViolations[index];
+        violation.type = type;
+        violation.call = call;
+        std::strncpy(violation.nodeName, currentNode, sizeof(violation.nodeName) - 1);
+        violation.nodeName[sizeof(violation.nodeName) - 1] = 0;
+    }
+
+    if (getMode() == Mode::Trap)
+    {
+        if (juce::Process::isRunningUnderDebugger())
+        {
+            JUCE_BREAK_IN_DEBUGGER;
+        }
+        else
+        {
+            std::abort();
+        }
+    }
+
+    insideHook = false;
+}
+
+int RealtimeSafetyAuditor::getNumViolations() noexcept
+{
+    return numViolations.load();
+}
+
+juce::Array<RealtimeSafetyAuditor::Violation> RealtimeSafetyAuditor::getViolations()
+{
+    juce::Array<Violation> result;
+    auto numRecorded = juce::jmin(numViolations.load(), maxRecordedViolations);
+
+    for (int i = 0; i < numRecorded; ++i)
+        result.add(recordedViolations[i]);
+
+    return result;
+}
+
+juce::String RealtimeSafetyAuditor::getReport()
+{
+    auto total = getNumViolations();
+
+    if (total == 0)
+        return "No real-time safety violations recorded";
+
+    // Group by node and call so repeated offences read as one line
+    std::map<juce::String, int> counts;
+
+    for (auto& violation : getViolations())
+    {
+        auto key = juce::String(violation.nodeName) + ": "
+                 + getViolationTypeName(violation.type) + " (" + violation.call + ")";
+        ++counts[key];
+    }
+
+    juce::String report;
+    report << total << " real-time safety violation(s) recorded";
+
+    if (total > maxRecordedViolations)
+        report << ", first " << maxRecordedViolations << " shown";
+
+    report << juce::newLine;
+
+    for (auto& entry : counts)
+        report << "  " << entry.first << " x" << entry.second << juce::newLine;
+
+    return report;
+}
+
+void RealtimeSafetyAuditor::reset() noexcept
+{
+    numViolations.store(0);
+}
+
+juce::String RealtimeSafetyAuditor::getViolationTypeName(ViolationType type)
+{
+    switch (type)
+    {
+        case ViolationType::Allocation:   return "Allocation";
+        case ViolationType::Deallocation: return "Deallocation";
+        case ViolationType::MutexLock:    return "Mutex lock";
+        case ViolationType::SystemCall:   return "System call";
+        default:                          return "Unknown";
+    }
+}
+
+//==============================================================================
+#if PLUGINLAB_RT_SAFETY_AUDIT
+
+namespace
+{
+    void* auditedAllocate(std::size_t size, const char* call)
+    {
+        RealtimeSafetyAuditor::reportViolation(RealtimeSafetyAuditor::ViolationType::Allocation, call);
+
+        if (auto* ptr = std::malloc(size == 0 ? 1 : size))
+            return ptr;
+
+        throw std::bad_alloc();
+    }
+
+    void* auditedAllocateAligned(std::size_t size, std::align_val_t alignment, const char* call)
+    {
+        RealtimeSafetyAuditor::reportViolation(RealtimeSafetyAuditor::ViolationType::Allocation, call);
+
+        void* ptr = nullptr;
+
+       #if JUCE_WINDOWS
+        ptr = _aligned_malloc(size == 0 ? 1 : size, static_cast<std::size_t>(alignment));
+       #else
+        if (posix_memalign(&ptr, juce::jmax(sizeof(void*), static_cast<std::size_t>(alignment)), size == 0 ? 1 : size) != 0)
+            ptr = nullptr;
+       #endif
+
+        if (ptr == nullptr)
+            throw std::bad_alloc();
+
+        return ptr;
+    }
+
+    void auditedFree(void* ptr, const char* call) noexcept
+    {
+        if (ptr == nullptr)
+            return;
+
+        RealtimeSafetyAuditor::reportViolation(RealtimeSafetyAuditor::ViolationType::Deallocation, call);
+        std::free(ptr);
+    }
+
+    void auditedFreeAligned(void* ptr, const char* call) noexcept
+    {
+        if (ptr == nullptr)
+            return;
+
+        RealtimeSafetyAuditor::reportViolation(RealtimeSafetyAuditor::ViolationType::Deallocation, call);
+
+       #if JUCE_WINDOWS
+        _aligned_free(ptr);
+       #else
+        std::free(ptr);
+       #endif
+    }
+}
+
+// Global allocation hooks
+void* operator new(std::size_t size)                                   { return auditedAllocate(size, "operator new"); }
+void* operator new[](std::size_t size)                                 { return auditedAllocate(size, "operator new[]"); }
+void* operator new(std::size_t size, std::align_val_t alignment)       { return auditedAllocateAligned(size, alignment, "operator new"); }
+void* operator new[](std::size_t size, std::align_val_t alignment)     { return auditedAllocateAligned(size, alignment, "operator new[]"); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return auditedAllocate(size, "operator new"); }
+    catch (...) { return nullptr; }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return auditedAllocate(size, "operator new[]"); }
+    catch (...) { return nullptr; }
+}
+
+void operator delete(void* ptr) noexcept                                       { auditedFree(ptr, "operator delete"); }
+void operator delete[](void* ptr) noexcept                                     { auditedFree(ptr, "operator delete[]"); }
+void operator delete(void* ptr, std::size_t) noexcept                          { auditedFree(ptr, "operator delete"); }
+void operator delete[](void* ptr, std::size_t) noexcept                        { auditedFree(ptr, "operator delete[]"); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept                { auditedFree(ptr, "operator delete"); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept              { auditedFree(ptr, "operator delete[]"); }
+void operator delete(void* ptr, std::align_val_t) noexcept                     { auditedFreeAligned(ptr, "operator delete"); }
+void operator delete[](void* ptr, std::align_val_t) noexcept                   { auditedFreeAligned(ptr, "operator delete[]"); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept        { auditedFreeAligned(ptr, "operator delete"); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept      { auditedFreeAligned(ptr, "operator delete[]"); }
+
+#if JUCE_LINUX
+// Lock and system-call hooks. Defining these in the executable pre-empts the
+// libc/libpthread symbols; the real implementations are looked up lazily.
+namespace
+{
+    template <typename FunctionType>
+    FunctionType findRealFunction(FunctionType& cached, const char* name) noexcept
+    {
+        if (cached == nullptr)
+            cached = reinterpret_cast<FunctionType>(dlsym(RTLD_NEXT, name));
+
+        return cached;
+    }
+
+    void reportSystemCall(const char* call) noexcept
+    {
+        RealtimeSafetyAuditor::reportViolation(RealtimeSafetyAuditor::ViolationType::SystemCall, call);
+    }
+}
+
+extern "C"
+{
+    int pthread_mutex_lock(pthread_mutex_t* mutex)
+    {
+        static int (*real)(pthread_mutex_t*) = nullptr;
+        RealtimeSafetyAuditor::reportViolation(RealtimeSafetyAuditor::ViolationType::MutexLock, "pthread_mutex_lock");
+        return findRealFunction(real, "pthread_mutex_lock")(mutex);
+    }
+
+    int pthread_cond_wait(pthread_cond_t* condition, pthread_mutex_t* mutex)
+    {
+        static int (*real)(pthread_cond_t*, pthread_mutex_t*) = nullptr;
+        reportSystemCall("pthread_cond_wait");
+        return findRealFunction(real, "pthread_cond_wait")(condition, mutex);
+    }
+
+    int nanosleep(const struct timespec* duration, struct timespec* remaining)
+    {
+        static int (*real)(const struct timespec*, struct timespec*) = nullptr;
+        reportSystemCall("nanosleep");
+        return findRealFunction(real, "nanosleep")(duration, remaining);
+    }
+
+    int usleep(useconds_t microseconds)
+    {
+        static int (*real)(useconds_t) = nullptr;
+        reportSystemCall("usleep");
+        return findRealFunction(real, "usleep")(microseconds);
+    }
+
+    ssize_t read(int fd, void* buffer, size_t count)
+    {
+        static ssize_t (*real)(int, void*, size_t) = nullptr;
+        reportSystemCall("read");
+        return findRealFunction(real, "read")(fd, buffer, count);
+    }
+
+    ssize_t write(int fd, const void* buffer, size_t count)
+    {
+        static ssize_t (*real)(int, const void*, size_t) = nullptr;
+        reportSystemCall("write");
+        return findRealFunction(real, "write")(fd, buffer, count);
+    }
+}
+#endif // JUCE_LINUX
+
+#endif // PLUGINLAB_RT_SAFETY_AUDIT
@@ -0,0 +1,94 @@
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+
+// The auditor is compiled into debug builds unless explicitly overridden
+#ifndef PLUGINLAB_RT_SAFETY_AUDIT
+ #define PLUGINLAB_RT_SAFETY_AUDIT JUCE_DEBUG
+#endif
+
+/**
+ * Debug instrumentation that catches calls which are not real-time safe
+ * (heap allocation, mutex locks and blocking system calls) while a node
+ * is rendering inside AudioProcessingGraph.
+ *
+ * Allocations are caught on every platform by replacing the global
+ * operator new/delete. Lock and system-call interception relies on
+ * symbol interposition and is only available on Linux.
+ *
+ * On macOS and Windows only allocations are audited: a node that takes a
+ * juce::CriticalSection, waits on a condition or sleeps is NOT reported there.
+ * Run --check-rt-safety on a Linux debug build to cover locks and system calls.
+ */
+class RealtimeSafetyAuditor
+{
+public:
+    enum class ViolationType
+    {
+        Allocation,
+        Deallocation,
+        MutexLock,
+        SystemCall
+    };
+
+    enum class Mode
+    {
+        Count,  // Record the violation and carry on
+        Trap    // Stop in the debugger, or abort when no debugger is attached
+    };
+
+    struct Violation
+    {
+        ViolationType type = ViolationType::Allocation;
+        const char* call = "";
+        char nodeName[64] = {};
+    };
+
+    /**
+     * Marks the current thread as rendering the given node for the lifetime of the scope.
+     * The name must stay valid until the scope ends and should be cached off the audio
+     * thread, since building a juce::String here would itself allocate.
+     */
+    class ScopedAudit
+    {
+    public:
+        explicit ScopedAudit(const char* nodeName) noexcept;
+        ~ScopedAudit() noexcept;
+
+    private:
+       #if PLUGINLAB_RT_SAFETY_AUDIT
+        const char* previousNode;
+       #endif
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedAudit)
+    };
+
+    // Audit mode
+    static void setMode(Mode newMode) noexcept;
+    static Mode getMode() noexcept;
+
+    // Called by the hooks - records the violation against the node on the current thread
+    static void reportViolation(ViolationType type, const char* call) noexcept;
+
+    // True when the calling thread is inside an audited processBlock
+    static bool isAuditingCurrentThread() noexcept;
+
+    // False where only allocations are audited - see the class description
+    static bool canAuditLocksAndSystemCalls() noexcept;
+
+    // Results - safe to call from tests or the message thread
+    static int getNumViolations() noexcept;
+    static juce::Array<Violation> getViolations();
+    static juce::String getReport();
+    static void reset() noexcept;
+
+    static juce::String getViolationTypeName(ViolationType type);
+
+private:
+    RealtimeSafetyAuditor() = delete;
+};
+
+#if ! PLUGINLAB_RT_SAFETY_AUDIT
+inline RealtimeSafetyAuditor::ScopedAudit::ScopedAudit(const char*) noexcept {}
+inline RealtimeSafetyAuditor::ScopedAudit::~ScopedAudit() noexcept {}
+#endif
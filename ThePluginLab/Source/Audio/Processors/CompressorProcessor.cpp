@@ -18,15 +18,25 @@ void CompressorProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
     spec.maximumBlockSize = samplesPerBlock;
     spec.numChannels = getTotalNumOutputChannels();
     
-    compressor.prepare(spec);
-    gain.prepare(spec);
+    // Only the chain matching the processing precision is used
+    if (isUsingDoublePrecision())
+    {
+        compressorDouble.prepare(spec);
+        gainDouble.prepare(spec);
+    }
+    else
+    {
+        compressor.prepare(spec);
+        gain.prepare(spec);
+    }
     
     // Set initial parameters
-    compressor.setThreshold(threshold);
-    compressor.setRatio(ratio);
-    compressor.setAttack(attack);
-    compressor.setRelease(release);
-    gain.setGainDecibels(makeupGain);
+    updateDspParameters();
+    
+    // Telemetry columns cover the same time at any block size
+    telemetryColumnSamples = juce::jmax(1, juce::roundToInt(sampleRate * telemetryColumnSeconds));
+    pendingTelemetrySamples = 0;
+    pendingTelemetry = {};
 }
 
 void CompressorProcessor::releaseResources()
@@ -34,43 +44,131 @@ void CompressorProcessor::releaseResources()
     // Release resources when no longer playing
 }
 
+void CompressorProcessor::reset()
+{
+    compressor.reset();
+    gain.reset();
+    compressorDouble.reset();
+    gainDouble.reset();
+    
+    currentGainReduction.store(0.0f, std::memory_order_relaxed);
+    
+    // Whatever is still queued describes audio from before the reset
+    pendingTelemetrySamples = 0;
+    pendingTelemetry = {};
+    telemetryFifo.finishedRead(telemetryFifo.getNumReady());
+}
+
 void CompressorProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processSamples(buffer, compressor, gain);
+}
+
+void CompressorProcessor::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processSamples(buffer, compressorDouble, gainDouble);
+}
+
+template <typename SampleType>
+void CompressorProcessor::processSamples(juce::AudioBuffer<SampleType>& buffer,
+                                         juce::dsp::Compressor<SampleType>& compressorToUse,
+                                         juce::dsp::Gain<SampleType>& gainToUse)
 {
     juce::ScopedNoDenormals noDenormals;
     
-    // Make a copy of the buffer before compression to calculate gain reduction
-    juce::AudioBuffer<float> inputCopy;
-    inputCopy.makeCopyOf(buffer);
+    const int numSamples = buffer.getNumSamples();
+    juce::dsp::AudioBlock<SampleType> block(buffer);
     
-    // Process with the compressor and makeup gain
-    juce::dsp::AudioBlock<float> block(buffer);
-    juce::dsp::ProcessContextReplacing<float> context(block);
-    
-    compressor.process(context);
-    gain.process(context);
+    // Processed in stretches that end on telemetry column boundaries, so each column
+    // holds the same amount of audio however the host splits it into blocks
+    for (int start = 0; start < numSamples;)
+    {
+        const int length = juce::jmin(numSamples - start, telemetryColumnSamples - pendingTelemetrySamples);
+        
+        // Measure the input peak before processing, rather than copying the buffer
+        SampleType maxInputLevel = 0;
+        
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            maxInputLevel = std::max(maxInputLevel, buffer.getMagnitude(channel, start, length));
+        
+        // Process with the compressor and makeup gain
+        auto stretch = block.getSubBlock((size_t) start, (size_t) length);
+        juce::dsp::ProcessContextReplacing<SampleType> context(stretch);
+        
+        compressorToUse.process(context);
+        gainToUse.process(context);
+        
+        SampleType maxOutputLevel = 0;
+        
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            maxOutputLevel = std::max(maxOutputLevel, buffer.getMagnitude(channel, start, length));
+        
+        // Convert to dB
+        float inputLevelDb = maxInputLevel > 0 ? 20.0f * std::log10((float) maxInputLevel) : -100.0f;
+        float outputLevelDb = maxOutputLevel > 0 ? 20.0f * std::log10((float) maxOutputLevel) : -100.0f;
+        
+        // Calculate gain reduction (without makeup gain), ensuring it's positive (it's a reduction)
+        const float gainReduction = std::max(0.0f, inputLevelDb - outputLevelDb + makeupGain);
+        currentGainReduction.store(gainReduction, std::memory_order_relaxed);
+        
+        addToTelemetryColumn(inputLevelDb, outputLevelDb, gainReduction, length);
+        start += length;
+    }
+}
+
+void CompressorProcessor::addToTelemetryColumn(float inputLevelDb, float outputLevelDb,
+                                               float gainReductionDb, int numSamples) noexcept
+{
+    pendingTelemetry.inputLevelDb = std::max(pendingTelemetry.inputLevelDb, inputLevelDb);
+    pendingTelemetry.outputLevelDb = std::max(pendingTelemetry.outputLevelDb, outputLevelDb);
+    pendingTelemetry.gainReductionDb = std::max(pendingTelemetry.gainReductionDb, gainReductionDb);
+    pendingTelemetrySamples += numSamples;
     
-    // Manually calculate gain reduction by comparing before/after levels
-    float maxInputLevel = 0.0f;
-    float maxOutputLevel = 0.0f;
+    if (pendingTelemetrySamples >= telemetryColumnSamples)
+    {
+        pushTelemetry(pendingTelemetry);
+        pendingTelemetry = {};
+        pendingTelemetrySamples = 0;
+    }
+}
+
+void CompressorProcessor::pushTelemetry(const Telemetry& telemetry) noexcept
+{
+    int start1, size1, start2, size2;
+    telemetryFifo.prepareToWrite(1, start1, size1, start2, size2);
     
-    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    if (size1 > 0)
     {
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-        {
-            maxInputLevel = std::max(maxInputLevel, std::abs(inputCopy.getSample(channel, sample)));
-            maxOutputLevel = std::max(maxOutputLevel, std::abs(buffer.getSample(channel, sample)));
-        }
+        telemetryBuffer[(size_t) start1] = telemetry;
+        telemetryFifo.finishedWrite(1);
     }
+}
+
+int CompressorProcessor::readTelemetry(Telemetry* destination, int maxToRead)
+{
+    int start1, size1, start2, size2;
+    telemetryFifo.prepareToRead(maxToRead, start1, size1, start2, size2);
     
-    // Convert to dB
-    float inputLevelDb = maxInputLevel > 0.0f ? 20.0f * std::log10(maxInputLevel) : -100.0f;
-    float outputLevelDb = maxOutputLevel > 0.0f ? 20.0f * std::log10(maxOutputLevel) : -100.0f;
+    std::copy_n(telemetryBuffer.begin() + start1, size1, destination);
+    std::copy_n(telemetryBuffer.begin() + start2, size2, destination + size1);
     
-    // Calculate gain reduction (without makeup gain)
-    currentGainReduction = inputLevelDb - outputLevelDb + makeupGain;
+    telemetryFifo.finishedRead(size1 + size2);
+    return size1 + size2;
+}
+
+void CompressorProcessor::updateDspParameters()
+{
+    compressor.setThreshold(threshold);
+    compressor.setRatio(ratio);
+    compressor.setAttack(attack);
+    compressor.setRelease(release);
+    gain.setGainDecibels(makeupGain);
     
-    // Ensure gain reduction is positive (it's a reduction)
-    currentGainReduction = std::max(0.0f, currentGainReduction);
+    compressorDouble.setThreshold(threshold);
+    compressorDouble.setRatio(ratio);
+    compressorDouble.setAttack(attack);
+    compressorDouble.setRelease(release);
+    gainDouble.setGainDecibels(makeupGain);
 }
 
 juce::AudioProcessorEditor* CompressorProcessor::createEditor()
@@ -137,46 +235,47 @@ void CompressorProcessor::setStateInformation(const void* data, int sizeInBytes)
     makeupGain = stream.readFloat();
     
     // Update DSP parameters
-    compressor.setThreshold(threshold);
-    compressor.setRatio(ratio);
-    compressor.setAttack(attack);
-    compressor.setRelease(release);
-    gain.setGainDecibels(makeupGain);
+    updateDspParameters();
 }
 
 void CompressorProcessor::setThreshold(float thresholdDb)
 {
     threshold = thresholdDb;
     compressor.setThreshold(threshold);
+    compressorDouble.setThreshold(threshold);
 }
 
 void CompressorProcessor::setRatio(float newRatio)
 {
     ratio = newRatio;
     compressor.setRatio(ratio);
+    compressorDouble.setRatio(ratio);
 }
 
 void CompressorProcessor::setAttack(float attackMs)
 {
     attack = attackMs;
     compressor.setAttack(attack);
+    compressorDouble.setAttack(attack);
 }
 
 void CompressorProcessor::setRelease(float releaseMs)
 {
     release = releaseMs;
     compressor.setRelease(release);
+    compressorDouble.setRelease(release);
 }
 
 void CompressorProcessor::setMakeupGain(float gainDb)
 {
     makeupGain = gainDb;
     gain.setGainDecibels(makeupGain);
+    gainDouble.setGainDecibels(makeupGain);
 }
 
 float CompressorProcessor::getGainReduction() const
 {
-    return currentGainReduction;
+    return currentGainReduction.load(std::memory_order_relaxed);
 }
 
 // MIDI handling methods
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <array>
+#include <atomic>
 #include "../../Common/Types.h"
 
 /**
@@ -16,6 +18,12 @@ public:
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
     void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) override;
+    void processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages) override;
+    bool supportsDoublePrecisionProcessing() const override { return true; }
+    
+    // Clears the envelope and gain smoothing of both chains and drops any queued
+    // telemetry. Call with audio stopped, from the thread that reads the telemetry.
+    void reset() override;
     
     // MIDI handling
     bool acceptsMidi() const override;
@@ -49,7 +57,32 @@ public:
     // Metering
     float getGainReduction() const;
     
+    // Levels over a fixed telemetryColumnSeconds of audio, whatever the block size,
+    // pushed from the audio thread through a lock-free FIFO. Peaks and gain
+    // reduction are the maximum over the column.
+    static constexpr double telemetryColumnSeconds = 0.01;
+    
+    struct Telemetry
+    {
+        float inputLevelDb = -100.0f;
+        float outputLevelDb = -100.0f;
+        float gainReductionDb = 0.0f;
+    };
+    
+    // Copies up to maxToRead queued columns, oldest first, and returns how many.
+    // Single consumer - normally the visualizer on the message thread.
+    int readTelemetry(Telemetry* destination, int maxToRead);
+    
 private:
+    // Shared render path for both sample types
+    template <typename SampleType>
+    void processSamples(juce::AudioBuffer<SampleType>& buffer,
+                        juce::dsp::Compressor<SampleType>& compressorToUse,
+                        juce::dsp::Gain<SampleType>& gainToUse);
+    
+    // Pushes the current parameters to both DSP chains
+    void updateDspParameters();
+    
     // Compressor parameters
     float threshold = 0.0f;
     float ratio = 1.0f;
@@ -61,8 +94,26 @@ private:
     juce::dsp::Compressor<float> compressor;
     juce::dsp::Gain<float> gain;
     
+    // Double-precision chain, used when the host processes in double
+    juce::dsp::Compressor<double> compressorDouble;
+    juce::dsp::Gain<double> gainDouble;
+    
     // Metering
-    float currentGainReduction = 0.0f;
+    std::atomic<float> currentGainReduction { 0.0f };
+    
+    // Columns are dropped rather than blocking the audio thread when the reader falls behind
+    static constexpr int telemetryCapacity = 512;
+    juce::AbstractFifo telemetryFifo { telemetryCapacity };
+    std::array<Telemetry, telemetryCapacity> telemetryBuffer;
+    
+    // Column being filled on the audio thread; its length is set in prepareToPlay
+    int telemetryColumnSamples = 441;
+    int pendingTelemetrySamples = 0;
+    Telemetry pendingTelemetry;
+    
+    // Max-holds one stretch of audio into the pending column, pushing it once full
+    void addToTelemetryColumn(float inputLevelDb, float outputLevelDb, float gainReductionDb, int numSamples) noexcept;
+    void pushTelemetry(const Telemetry& telemetry) noexcept;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CompressorProcessor)
 };
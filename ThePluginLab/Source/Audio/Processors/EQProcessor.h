@@ -3,7 +3,8 @@
 
 /**
  * SIMPLIFIED EQ Processor for GUI prototype only
- * This class only stores parameter data for visualization
+ * This class only stores parameter data for visualization, and builds the
+ * IIR coefficients the response curve is drawn from.
  * No actual audio processing is implemented
  */
 class EQProcessor 
@@ -88,6 +89,34 @@ public:
     
     int getNumBands() const { return 8; }
     
+    // Sample rate the band coefficients are designed for
+    void setSampleRate(double newSampleRate) {
+        if (newSampleRate > 0.0) sampleRate = newSampleRate;
+    }
+    
+    double getSampleRate() const { return sampleRate; }
+    
+    // IIR coefficients for a band's current settings
+    juce::dsp::IIR::Coefficients<float>::Ptr makeCoefficients(int band) const {
+        using Coefficients = juce::dsp::IIR::Coefficients<float>;
+        
+        const auto& b = bands[juce::jlimit(0, 7, band)];
+        const auto frequency = juce::jlimit(1.0f, (float) (sampleRate * 0.49), b.frequency);
+        const auto q = juce::jmax(0.01f, b.q);
+        const auto gainFactor = juce::Decibels::decibelsToGain(b.gainDb);
+        
+        switch (b.type) {
+            case FilterType::LowPass:   return Coefficients::makeLowPass(sampleRate, frequency, q);
+            case FilterType::HighPass:  return Coefficients::makeHighPass(sampleRate, frequency, q);
+            case FilterType::LowShelf:  return Coefficients::makeLowShelf(sampleRate, frequency, q, gainFactor);
+            case FilterType::HighShelf: return Coefficients::makeHighShelf(sampleRate, frequency, q, gainFactor);
+            case FilterType::BandPass:  return Coefficients::makeBandPass(sampleRate, frequency, q);
+            case FilterType::Notch:     return Coefficients::makeNotch(sampleRate, frequency, q);
+            case FilterType::Peak:
+            default:                    return Coefficients::makePeakFilter(sampleRate, frequency, q, gainFactor);
+        }
+    }
+    
     // Educational descriptions
     juce::String getFilterTypeDescription(FilterType type) const {
         switch (type) {
@@ -124,4 +153,5 @@ public:
     
 private:
     FilterBand bands[8];
+    double sampleRate = 44100.0;
 };
@@ -1,6 +1,7 @@
 #pragma once
 #include <JuceHeader.h>
 #include "Types.h"
+#include "Features.h"
 
 /**
  * Centralized location for helper functions to avoid duplication
@@ -62,4 +63,23 @@ namespace Helpers
             
         return juce::Colours::grey;
     }
+    
+    /**
+     * Read an integer command line option written as "--name N" or "--name=N".
+     * juce::ArgumentList::getValueForOption only understands the second form.
+     */
+    inline int getIntOption(const juce::ArgumentList& arguments, juce::StringRef option, int defaultValue)
+    {
+        const auto index = arguments.indexOfOption(option);
+        
+        if (index < 0)
+            return defaultValue;
+            
+        auto value = arguments[index].getLongOptionValue();
+        
+        if (value.isEmpty() && index + 1 < arguments.size() && ! arguments[index + 1].isOption())
+            value = arguments[index + 1].text;
+            
+        return value.isNotEmpty() && value.containsOnly("0123456789") ? value.getIntValue() : defaultValue;
+    }
 }
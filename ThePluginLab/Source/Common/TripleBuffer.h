@@ -0,0 +1,52 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+/**
+ * Lock-free single-producer/single-consumer triple buffer.
+ *
+ * The producer fills getWriteBuffer() and calls publish(); the consumer calls
+ * acquireLatest() and then reads getReadBuffer(). Each side always owns a
+ * whole buffer, so the consumer never sees a half-written frame and the
+ * producer never waits. Unread frames are simply replaced by newer ones.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+
+    // Producer side
+    T& getWriteBuffer() noexcept { return buffers[(size_t) writeIndex]; }
+
+    void publish() noexcept
+    {
+        auto previous = middleIndex.exchange(writeIndex | newDataFlag, std::memory_order_acq_rel);
+        writeIndex = previous & indexMask;
+    }
+
+    // Consumer side - returns true if a new frame was swapped in
+    bool acquireLatest() noexcept
+    {
+        if ((middleIndex.load(std::memory_order_relaxed) & newDataFlag) == 0)
+            return false;
+
+        auto previous = middleIndex.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & indexMask;
+        return true;
+    }
+
+    const T& getReadBuffer() const noexcept { return buffers[(size_t) readIndex]; }
+
+private:
+    static constexpr int indexMask = 0x3;
+    static constexpr int newDataFlag = 0x4;
+
+    std::array<T, 3> buffers {};
+    int writeIndex = 0;
+    std::atomic<int> middleIndex { 1 };
+    int readIndex = 2;
+
+    JUCE_DECLARE_NON_COPYABLE(TripleBuffer)
+};
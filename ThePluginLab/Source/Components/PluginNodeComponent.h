@@ -32,6 +32,8 @@ public:
     // Get port accessors - pure virtual methods
     virtual AudioConnectionPoint* getInputPort(int index) const = 0;
     virtual AudioConnectionPoint* getOutputPort(int index) const = 0;
+    virtual int getNumInputPorts() const = 0;
+    virtual int getNumOutputPorts() const = 0;
     
     // Get node properties
     juce::String getName() const { return nodeName; }
@@ -45,10 +45,18 @@ void AudioConnection::paint(juce::Graphics& g)
     
     // Draw arrow to indicate flow direction
     float arrowSize = 8.0f;
-    float distanceAlongPath = 0.7f; // 70% along the path
+    float t = 0.7f; // 70% along the curve
     
-    juce::Point<float> arrowPos = path.getPointAlongPath(path.getLength() * distanceAlongPath);
-    juce::Point<float> direction = path.getPointAlongPath(path.getLength() * (distanceAlongPath + 0.01f)) - arrowPos;
+    // Evaluate the bezier and its tangent directly, rather than flattening the
+    // curve into line segments three times to measure and walk along it
+    const auto p0 = sourcePos.toFloat();
+    const auto p3 = destPos.toFloat();
+    const float u = 1.0f - t;
+    
+    juce::Point<float> arrowPos = p0 * (u * u * u) + control1 * (3.0f * u * u * t)
+                                + control2 * (3.0f * u * t * t) + p3 * (t * t * t);
+    juce::Point<float> direction = (control1 - p0) * (3.0f * u * u) + (control2 - control1) * (6.0f * u * t)
+                                 + (p3 - control2) * (3.0f * t * t);
     
     // Normalize the direction vector
     float mag = std::sqrt(direction.x * direction.x + direction.y * direction.y);
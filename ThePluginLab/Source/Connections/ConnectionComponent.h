@@ -4,36 +4,28 @@
 class AudioConnectionPoint;
 
 /**
- * Visual representation of a connection between two AudioConnectionPoints
+ * A connection between two AudioConnectionPoints
+ *
+ * Connections are not child components: the canvas's WireLayer draws and
+ * hit-tests all of them, so this only records the endpoints.
  */
-class ConnectionComponent : public juce::Component
+class ConnectionComponent
 {
 public:
-    ConnectionComponent();
-    ~ConnectionComponent() override;
+    ConnectionComponent() = default;
     
     // Set connection endpoints
-    void setSourcePoint(AudioConnectionPoint* source);
-    void setDestinationPoint(AudioConnectionPoint* destination);
+    void setSourcePoint(AudioConnectionPoint* source) { sourcePoint = source; }
+    void setDestinationPoint(AudioConnectionPoint* destination) { destinationPoint = destination; }
     
     // Get connection endpoints
     AudioConnectionPoint* getSourcePoint() const { return sourcePoint; }
     AudioConnectionPoint* getDestinationPoint() const { return destinationPoint; }
     
-    // Update the position of the connection line to match the connection points
-    void updatePosition();
-    
-    // Component overrides
-    void paint(juce::Graphics& g) override;
-    void mouseDown(const juce::MouseEvent& e) override;
-    
 private:
     // Connection endpoints
     AudioConnectionPoint* sourcePoint = nullptr;
     AudioConnectionPoint* destinationPoint = nullptr;
     
-    // Line path
-    juce::Path connectionPath;
-    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ConnectionComponent)
 };
@@ -1,29 +1,21 @@
 #pragma once
 #include <JuceHeader.h>
+#include "FrameScheduler.h"
 
 /**
  * Helper class to safely manage animation frames and display links
- * This helps prevent crashes related to DisplayLink destruction
+ * Frames come from the shared FrameScheduler, which owns the single
+ * display link, so individual helpers never create or destroy one
  */
-class AnimationHelper : public juce::Timer
+class AnimationHelper
 {
 public:
-    AnimationHelper() 
-    {
-        // Use timer-based animation instead of DisplayLink for safety
-        startTimerHz(60);
-    }
-    
-    ~AnimationHelper() override
-    {
-        // Stop timer before destruction
-        stopTimer();
-    }
+    AnimationHelper() = default;
     
-    void timerCallback() override
+    ~AnimationHelper()
     {
-        if (onAnimationFrame)
-            onAnimationFrame();
+        // Stop callbacks before destruction
+        stopAnimation();
     }
     
     // Set callback to be called on animation frame
@@ -33,9 +25,11 @@ public:
     }
     
     // Start/stop animation
-    void startAnimation() { startTimerHz(60); }
-    void stopAnimation() { stopTimer(); }
+    void startAnimation() { frameClient.setActive(true); }
+    void stopAnimation() { frameClient.setActive(false); }
     
 private:
     std::function<void()> onAnimationFrame;
+    
+    FrameScheduler::Client frameClient { nullptr, [this] { if (onAnimationFrame) onAnimationFrame(); } };
 };
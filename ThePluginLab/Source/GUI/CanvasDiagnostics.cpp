@@ -0,0 +1,175 @@
+#include "CanvasDiagnostics.h"
+#include <cmath>
+#include <iostream>
+#include "PluginEditorCanvas.h"
+#include "../Components/ConcretePluginNode.h"
+#include "../Connections/AudioConnectionPoint.h"
+#include "../Common/Helpers.h"
+
+namespace
+{
+    // Total area of a region whose rectangles don't overlap, as RectangleList keeps them
+    juce::int64 getArea(const juce::RectangleList<int>& region)
+    {
+        juce::int64 area = 0;
+
+        for (auto& rectangle : region)
+            area += (juce::int64) rectangle.getWidth() * rectangle.getHeight();
+
+        return area;
+    }
+
+    // Ports are added before the node goes onto the canvas, so the port index sees them
+    ConcretePluginNode* addTestNode(PluginEditorCanvas& canvas, const juce::String& name, int x, int y, bool isHub)
+    {
+        auto node = std::make_unique<ConcretePluginNode>(name, juce::Colours::grey);
+        node->setTopLeftPosition(x, y);
+
+        if (isHub)
+            node->addOutputPort("Out");
+        else
+            node->addInputPort("In");
+
+        auto* nodePtr = node.get();
+        canvas.addNode(std::move(node));
+        return nodePtr;
+    }
+}
+
+bool CanvasDiagnostics::handlesCommandLine(const juce::String& commandLine)
+{
+    return commandLine.contains("--bench-canvas-hub");
+}
+
+int CanvasDiagnostics::runFromCommandLine(const juce::String& commandLine)
+{
+    juce::ArgumentList arguments("ThePluginLab", commandLine);
+    juce::String report;
+    bool passed = true;
+
+    if (arguments.containsOption("--bench-canvas-hub"))
+    {
+        const int numWires = Helpers::getIntOption(arguments, "--bench-canvas-hub", 500);
+        const int numSteps = Helpers::getIntOption(arguments, "--steps", 200);
+        passed = benchmarkHubDrag(report, juce::jmax(1, numWires), juce::jmax(1, numSteps)) && passed;
+    }
+
+    std::cout << report << std::flush;
+    return passed ? 0 : 1;
+}
+
+bool CanvasDiagnostics::benchmarkHubDrag(juce::String& report, int numWires, int numSteps)
+{
+    // The hub sits on the left, its wires fanning out to a grid of nodes on the right
+    constexpr int rowsPerColumn = 20;
+    constexpr int columnSpacing = 170;
+    constexpr int rowSpacing = 110;
+    constexpr int firstColumnX = 400;
+    constexpr int dragRadius = 40;
+
+    const int numColumns = (numWires + rowsPerColumn - 1) / rowsPerColumn;
+
+    PluginEditorCanvas canvas;
+    canvas.setSize(firstColumnX + numColumns * columnSpacing,
+                   juce::jmin(numWires, rowsPerColumn) * rowSpacing + 100);
+
+    const juce::Point<int> hubHome { 100, canvas.getHeight() / 2 - 50 };
+    auto* hub = addTestNode(canvas, "Hub", hubHome.x, hubHome.y, true);
+    auto* hubPort = hub->getOutputPort(0);
+
+    juce::Array<ConcretePluginNode*> leaves;
+
+    for (int i = 0; i < numWires; ++i)
+    {
+        auto* leaf = addTestNode(canvas, "Node " + juce::String(i),
+                                 firstColumnX + (i / rowsPerColumn) * columnSpacing,
+                                 50 + (i % rowsPerColumn) * rowSpacing, false);
+        canvas.addConnection(hubPort, leaf->getInputPort(0));
+        leaves.add(leaf);
+    }
+
+    const auto canvasArea = (double) canvas.getWidth() * canvas.getHeight();
+
+    report << "Canvas hub drag: 1 node wired to " << numWires << " others, " << numSteps << " drag steps on a "
+           << canvas.getWidth() << "x" << canvas.getHeight() << " canvas" << juce::newLine;
+
+    // Drag the hub round a small circle, as a mouse drag would move it, one step at a time
+    auto& wireLayer = canvas.wireLayer;
+    juce::RectangleList<int> repaintedRegion;
+    wireLayer.repaintRecorder = &repaintedRegion;
+
+    double meanMicroseconds = 0.0, maxMicroseconds = 0.0;
+    double meanRepaintedArea = 0.0, maxRepaintedArea = 0.0;
+    wireLayer.numRepaintRequests = 0;
+
+    for (int step = 1; step <= numSteps; ++step)
+    {
+        const auto angle = juce::MathConstants<double>::twoPi * step / numSteps;
+        const auto position = hubHome + juce::Point<int>(juce::roundToInt(dragRadius * std::sin(angle)),
+                                                         juce::roundToInt(dragRadius * (1.0 - std::cos(angle))));
+        repaintedRegion.clear();
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        hub->setTopLeftPosition(position);
+        const auto elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1.0e6;
+
+        meanMicroseconds += elapsed;
+        maxMicroseconds = juce::jmax(maxMicroseconds, elapsed);
+
+        const auto repaintedArea = (double) getArea(repaintedRegion) / canvasArea;
+        meanRepaintedArea += repaintedArea;
+        maxRepaintedArea = juce::jmax(maxRepaintedArea, repaintedArea);
+    }
+
+    wireLayer.repaintRecorder = nullptr;
+    meanMicroseconds /= numSteps;
+    meanRepaintedArea /= numSteps;
+
+    report << "  drag step: " << juce::String(meanMicroseconds, 2) << " us mean, "
+           << juce::String(maxMicroseconds, 2) << " us max, "
+           << juce::String((double) wireLayer.numRepaintRequests / numSteps, 1) << " wire repaints requested per step" << juce::newLine
+           << "  repainted area per step after merging: " << juce::String(100.0 * meanRepaintedArea, 1) << "% of the canvas mean, "
+           << juce::String(100.0 * maxRepaintedArea, 1) << "% max" << juce::newLine;
+
+    // Every wire must start where the hub's port now is
+    const auto hubPortCentre = wireLayer.getLocalPoint(hubPort, hubPort->getLocalBounds().getCentre().toFloat());
+    int numStaleWires = 0;
+
+    for (auto& wire : wireLayer.wires)
+        if (! wire.isValid || wire.start != hubPortCentre)
+            ++numStaleWires;
+
+    const bool wiresFollowed = wireLayer.getNumWires() == numWires && numStaleWires == 0;
+    report << "  wires followed the hub: " << (wiresFollowed ? juce::String("yes")
+                                                             : "NO - FAILED, " + juce::String(numStaleWires) + " stale") << juce::newLine;
+
+    // Removing a node on either end of the wires must take its connections with it
+    canvas.removeNode(leaves.getLast());
+    leaves.removeLast();
+
+    const bool leafRemoved = canvas.getNumConnections() == numWires - 1
+                          && wireLayer.getNumWires() == numWires - 1
+                          && hubPort->isConnected() == (numWires > 1);
+
+    canvas.removeNode(hub);
+
+    int numStillConnected = 0;
+
+    for (auto* leaf : leaves)
+        if (leaf->getInputPort(0)->isConnected())
+            ++numStillConnected;
+
+    const bool hubRemoved = canvas.getNumConnections() == 0
+                         && wireLayer.getNumWires() == 0
+                         && canvas.connectionsByPort.empty()
+                         && numStillConnected == 0;
+
+    report << "  removing a wired node drops its connections: "
+           << (leafRemoved && hubRemoved ? juce::String("yes")
+                                         : "NO - FAILED, " + juce::String(canvas.getNumConnections()) + " connections, "
+                                               + juce::String(wireLayer.getNumWires()) + " wires and "
+                                               + juce::String(numStillConnected) + " ports still marked connected")
+           << juce::newLine;
+
+    return wiresFollowed && leafRemoved && hubRemoved;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <JuceHeader.h>
+
+/**
+ * Headless checks for the plugin editor canvas, run from the command line and
+ * reported on stdout.
+ *
+ *   --bench-canvas-hub [N] [--steps S]
+ *                       Wires one hub node to N nodes (default 500), drags the hub
+ *                       for S steps (default 200) and reports the cost of each step,
+ *                       how many wires it updated and how much of the canvas it asked
+ *                       to repaint. Fails if the wires don't follow the hub, or if
+ *                       removing a wired node leaves connections behind.
+ *
+ * The canvas is never put on screen, so only the areas requested through the
+ * wire layer are measured, not the time spent painting them.
+ */
+class CanvasDiagnostics
+{
+public:
+    // True if the command line asks for one of the checks above
+    static bool handlesCommandLine(const juce::String& commandLine);
+
+    // Runs the requested checks, prints their reports and returns the process exit code
+    static int runFromCommandLine(const juce::String& commandLine);
+
+    // Each check appends to the report and returns false if it failed
+    static bool benchmarkHubDrag(juce::String& report, int numWires, int numSteps);
+
+private:
+    CanvasDiagnostics() = delete;
+};
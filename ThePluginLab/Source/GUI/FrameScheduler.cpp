@@ -0,0 +1,218 @@
+#include "FrameScheduler.h"
+
+JUCE_IMPLEMENT_SINGLETON(FrameScheduler)
+
+//==============================================================================
+FrameScheduler::Client::Client(juce::Component* componentToRepaint,
+                               std::function<void()> frameCallback,
+                               int rateDivider)
+    : component(componentToRepaint),
+      onFrame(std::move(frameCallback)),
+      divider(juce::jmax(1, rateDivider))
+{
+    FrameScheduler::getInstance()->addClient(*this);
+}
+
+FrameScheduler::Client::~Client()
+{
+    // The scheduler may already be gone at shutdown
+    if (auto* scheduler = FrameScheduler::getInstanceWithoutCreating())
+        scheduler->removeClient(*this);
+}
+
+FrameScheduler::Client::ScopedPaintTimer::ScopedPaintTimer(Client& clientToTime) noexcept
+    : client(clientToTime), startMs(juce::Time::getMillisecondCounterHiRes())
+{
+}
+
+FrameScheduler::Client::ScopedPaintTimer::~ScopedPaintTimer() noexcept
+{
+    client.lastPaintMs = juce::Time::getMillisecondCounterHiRes() - startMs;
+
+    if (auto* scheduler = FrameScheduler::getInstanceWithoutCreating())
+        scheduler->paintMsThisFrame += client.lastPaintMs;
+}
+
+//==============================================================================
+FrameScheduler::FrameScheduler()
+    : frameIntervals((size_t) frameHistoryLength, 0.0f)
+{
+    // Default budget: half a 60 Hz frame, leaving the rest for layout and compositing
+    stats.paintBudgetMs = 8.0;
+}
+
+FrameScheduler::~FrameScheduler()
+{
+    stopTimer();
+    cancelPendingUpdate();
+    vblankAttachment.reset();
+    clearSingletonInstance();
+}
+
+void FrameScheduler::addClient(Client& client)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    clients.push_back(&client);
+    updateFrameSource();
+}
+
+void FrameScheduler::removeClient(Client& client)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    clients.erase(std::remove(clients.begin(), clients.end(), &client), clients.end());
+
+    // This may be running inside the vblank callback, which the attachment can't
+    // survive being deleted from. Drop the source component so the attachment is
+    // replaced asynchronously; it stops firing by itself if the component goes.
+    if (client.component != nullptr && client.component == vblankComponent.getComponent())
+        vblankComponent = nullptr;
+
+    triggerAsyncUpdate();
+}
+
+void FrameScheduler::updateFrameSource()
+{
+    // Keep the current vblank source while its component is still on screen
+    if (vblankAttachment != nullptr && vblankComponent != nullptr && vblankComponent->isShowing())
+        return;
+
+    vblankAttachment.reset();
+    vblankComponent = nullptr;
+
+    for (auto* client : clients)
+    {
+        if (client->component != nullptr && client->component->isShowing())
+        {
+            vblankComponent = client->component;
+            vblankAttachment = std::make_unique<juce::VBlankAttachment>(client->component, [this] { processFrame(); });
+            break;
+        }
+    }
+
+    stats.vsyncDriven = vblankAttachment != nullptr;
+
+    // Nothing is on screen to sync to yet - tick from a timer until something is
+    if (stats.vsyncDriven || clients.empty())
+        stopTimer();
+    else if (! isTimerRunning())
+        startTimerHz(fallbackFrameRateHz);
+}
+
+void FrameScheduler::timerCallback()
+{
+    processFrame();
+}
+
+bool FrameScheduler::isOnScreen(juce::Component& component)
+{
+    if (! component.isShowing() || component.getWidth() <= 0 || component.getHeight() <= 0)
+        return false;
+
+    // Skip components that are scrolled away or fully covered by siblings
+    juce::RectangleList<int> visibleArea;
+    component.getVisibleArea(visibleArea, true);
+    return ! visibleArea.isEmpty();
+}
+
+void FrameScheduler::processFrame()
+{
+    auto now = juce::Time::getMillisecondCounterHiRes();
+
+    if (lastFrameStartMs > 0.0)
+    {
+        auto interval = (float) (now - lastFrameStartMs);
+        frameIntervals[(size_t) frameIntervalWritePosition] = interval;
+        frameIntervalWritePosition = (frameIntervalWritePosition + 1) % frameHistoryLength;
+
+        stats.maxFrameIntervalMs = 0.0;
+        double total = 0.0;
+
+        for (auto value : frameIntervals)
+        {
+            total += value;
+            stats.maxFrameIntervalMs = juce::jmax(stats.maxFrameIntervalMs, (double) value);
+        }
+
+        stats.averageFrameIntervalMs = total / frameHistoryLength;
+    }
+
+    lastFrameStartMs = now;
+    stats.lastFramePaintMs = paintMsThisFrame;
+    paintMsThisFrame = 0.0;
+    ++frameCount;
+
+    // Frame callbacks first - they may mark their own component dirty. Clients
+    // whose component is off screen are skipped, as there's nothing to show.
+    // (iterate by index: callbacks can create or destroy clients)
+    for (size_t i = 0; i < clients.size(); ++i)
+    {
+        auto* client = clients[i];
+
+        if (! client->active || ! client->onFrame || frameCount % (juce::uint64) client->divider != 0)
+            continue;
+
+        if (client->component != nullptr && ! isOnScreen(*client->component))
+            continue;
+
+        client->onFrame();
+    }
+
+    stats.numClients = (int) clients.size();
+    stats.repaintsLastFrame = 0;
+    stats.hiddenLastFrame = 0;
+    stats.deferredLastFrame = 0;
+
+    if (clients.empty())
+        return;
+
+    // Repaint dirty, visible clients round-robin until the estimated cost hits the budget
+    double estimatedPaintMs = 0.0;
+    const auto numClients = clients.size();
+    roundRobinStart %= numClients;
+
+    for (size_t n = 0; n < numClients; ++n)
+    {
+        auto* client = clients[(roundRobinStart + n) % numClients];
+
+        if (! client->active || client->component == nullptr
+            || ! client->dirty.load(std::memory_order_acquire))
+            continue;
+
+        if (! isOnScreen(*client->component))
+        {
+            // Stay dirty so it repaints as soon as it becomes visible
+            ++stats.hiddenLastFrame;
+            continue;
+        }
+
+        if (stats.repaintsLastFrame > 0 && estimatedPaintMs + client->lastPaintMs > stats.paintBudgetMs)
+        {
+            ++stats.deferredLastFrame;
+            continue;
+        }
+
+        client->dirty.store(false, std::memory_order_release);
+        
+        if (client->wholeComponentDirty.exchange(false, std::memory_order_relaxed) || client->dirtyArea.isEmpty())
+            client->component->repaint();
+        else
+            client->component->repaint(client->dirtyArea);
+        
+        client->dirtyArea = {};
+        estimatedPaintMs += client->lastPaintMs;
+        ++stats.repaintsLastFrame;
+    }
+
+    // Start after the last deferred client next time so nobody starves
+    roundRobinStart += (size_t) juce::jmax(1, stats.repaintsLastFrame);
+
+    // Re-home the vblank source if its component has been hidden. This can't
+    // happen inside the vblank callback itself, so it's done asynchronously.
+    if (vblankComponent == nullptr || ! vblankComponent->isShowing())
+        triggerAsyncUpdate();
+}
+
+void FrameScheduler::handleAsyncUpdate()
+{
+    updateFrameSource();
+}
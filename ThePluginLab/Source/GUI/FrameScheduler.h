@@ -0,0 +1,138 @@
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+/**
+ * Shared, display-synchronised repaint scheduler.
+ *
+ * Instead of each visualizer running its own juce::Timer, components own a
+ * FrameScheduler::Client. Once per display refresh (driven by a
+ * VBlankAttachment) the scheduler runs the frame callback of each client whose
+ * component is visible on screen, and repaints the visible clients that were
+ * marked dirty - at most once per frame. When the previous
+ * frame's painting overran the budget, the remaining dirty clients are
+ * deferred to the next frame in round-robin order.
+ */
+class FrameScheduler : private juce::Timer,
+                       private juce::AsyncUpdater,
+                       private juce::DeletedAtShutdown
+{
+public:
+    class Client
+    {
+    public:
+        /**
+         * component may be nullptr for clients that only need a frame tick.
+         * rateDivider runs the client on every Nth frame, e.g. 2 for ~30 Hz.
+         */
+        Client(juce::Component* componentToRepaint,
+               std::function<void()> frameCallback = {},
+               int rateDivider = 1);
+        ~Client();
+
+        // Request a repaint on the next frame. Safe to call from any thread.
+        void markDirty() noexcept
+        {
+            wholeComponentDirty.store(true, std::memory_order_relaxed);
+            dirty.store(true, std::memory_order_release);
+        }
+        
+        // Request a repaint of just part of the component. Message thread only;
+        // areas marked before the next frame are merged.
+        void markDirty(juce::Rectangle<int> area) noexcept
+        {
+            dirtyArea = dirtyArea.isEmpty() ? area : dirtyArea.getUnion(area);
+            dirty.store(true, std::memory_order_release);
+        }
+
+        // Inactive clients get no frame callbacks or repaints
+        void setActive(bool shouldBeActive) noexcept { active = shouldBeActive; }
+        bool isActive() const noexcept { return active; }
+
+        // Time a paint call so the scheduler can keep frames within budget
+        class ScopedPaintTimer
+        {
+        public:
+            explicit ScopedPaintTimer(Client& clientToTime) noexcept;
+            ~ScopedPaintTimer() noexcept;
+
+        private:
+            Client& client;
+            double startMs;
+
+            JUCE_DECLARE_NON_COPYABLE(ScopedPaintTimer)
+        };
+
+    private:
+        friend class FrameScheduler;
+
+        juce::Component* component;
+        std::function<void()> onFrame;
+        int divider;
+        bool active = true;
+        std::atomic<bool> dirty { true };
+        std::atomic<bool> wholeComponentDirty { true };
+        juce::Rectangle<int> dirtyArea;
+        double lastPaintMs = 0.0;
+
+        JUCE_DECLARE_NON_COPYABLE(Client)
+    };
+
+    struct Statistics
+    {
+        double averageFrameIntervalMs = 0.0;
+        double maxFrameIntervalMs = 0.0;
+        double lastFramePaintMs = 0.0;
+        double paintBudgetMs = 0.0;
+        int numClients = 0;
+        int repaintsLastFrame = 0;
+        int hiddenLastFrame = 0;     // Dirty but off-screen or fully occluded
+        int deferredLastFrame = 0;   // Dirty but pushed to the next frame by the budget
+        bool vsyncDriven = false;
+    };
+
+    Statistics getStatistics() const { return stats; }
+
+    // Recent frame intervals in ms, oldest first, for the frame-time overlay
+    const std::vector<float>& getFrameIntervalHistory() const { return frameIntervals; }
+    int getFrameIntervalHistoryPosition() const { return frameIntervalWritePosition; }
+
+    // Paint time allowed per frame before dirty clients start being deferred
+    void setPaintBudgetMs(double newBudgetMs) { stats.paintBudgetMs = juce::jmax(1.0, newBudgetMs); }
+
+    JUCE_DECLARE_SINGLETON(FrameScheduler, true)
+
+private:
+    FrameScheduler();
+    ~FrameScheduler() override;
+
+    void addClient(Client& client);
+    void removeClient(Client& client);
+
+    void processFrame();
+    void updateFrameSource();
+    void timerCallback() override;
+    void handleAsyncUpdate() override;
+    static bool isOnScreen(juce::Component& component);
+
+    std::vector<Client*> clients;
+    size_t roundRobinStart = 0;
+    juce::uint64 frameCount = 0;
+
+    // Frame source - a vblank attachment on a showing client, or a timer fallback
+    std::unique_ptr<juce::VBlankAttachment> vblankAttachment;
+    juce::Component::SafePointer<juce::Component> vblankComponent;
+
+    Statistics stats;
+    double paintMsThisFrame = 0.0;
+    double lastFrameStartMs = 0.0;
+    std::vector<float> frameIntervals;
+    int frameIntervalWritePosition = 0;
+
+    static constexpr int fallbackFrameRateHz = 60;
+    static constexpr int frameHistoryLength = 120;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FrameScheduler)
+};
@@ -0,0 +1,77 @@
+#pragma once
+#include <JuceHeader.h>
+#include "FrameScheduler.h"
+
+/**
+ * Profiling overlay showing the FrameScheduler's frame intervals, paint
+ * time against budget, and how many repaints were issued, skipped as hidden
+ * or deferred over budget. Add it on top of the area being profiled; it
+ * doesn't intercept mouse clicks.
+ */
+class FrameTimeOverlay : public juce::Component
+{
+public:
+    FrameTimeOverlay()
+    {
+        setInterceptsMouseClicks(false, false);
+        setSize(220, 90);
+    }
+
+    void paint(juce::Graphics& g) override
+    {
+        FrameScheduler::Client::ScopedPaintTimer paintTimer(frameClient);
+
+        auto* scheduler = FrameScheduler::getInstance();
+        auto stats = scheduler->getStatistics();
+        auto bounds = getLocalBounds().toFloat();
+
+        g.setColour(juce::Colours::black.withAlpha(0.7f));
+        g.fillRoundedRectangle(bounds, 4.0f);
+
+        // Frame interval history, 0-50 ms, with a 60 Hz reference line
+        auto graphArea = bounds.reduced(6.0f).removeFromBottom(40.0f);
+        const auto& intervals = scheduler->getFrameIntervalHistory();
+        const auto start = scheduler->getFrameIntervalHistoryPosition();
+        const auto numIntervals = (int) intervals.size();
+        const float maxMs = 50.0f;
+        const float barWidth = graphArea.getWidth() / (float) juce::jmax(1, numIntervals);
+
+        for (int i = 0; i < numIntervals; ++i)
+        {
+            auto value = intervals[(size_t) ((start + i) % numIntervals)];
+            auto barHeight = juce::jmin(1.0f, value / maxMs) * graphArea.getHeight();
+
+            g.setColour(value > 1000.0f / 60.0f * 1.5f ? juce::Colours::red : juce::Colours::limegreen);
+            g.fillRect(graphArea.getX() + i * barWidth, graphArea.getBottom() - barHeight,
+                       juce::jmax(1.0f, barWidth - 0.5f), barHeight);
+        }
+
+        g.setColour(juce::Colours::white.withAlpha(0.4f));
+        auto referenceY = graphArea.getBottom() - (1000.0f / 60.0f) / maxMs * graphArea.getHeight();
+        g.drawHorizontalLine((int) referenceY, graphArea.getX(), graphArea.getRight());
+
+        // Text summary
+        g.setColour(juce::Colours::white);
+        g.setFont(11.0f);
+
+        auto textArea = bounds.reduced(6.0f).removeFromTop(36.0f);
+        g.drawText(juce::String(stats.averageFrameIntervalMs, 1) + " ms avg, "
+                       + juce::String(stats.maxFrameIntervalMs, 1) + " ms max"
+                       + (stats.vsyncDriven ? " (vsync)" : " (timer)"),
+                   textArea.removeFromTop(12.0f), juce::Justification::left);
+        g.drawText("paint " + juce::String(stats.lastFramePaintMs, 2) + " / "
+                       + juce::String(stats.paintBudgetMs, 1) + " ms",
+                   textArea.removeFromTop(12.0f), juce::Justification::left);
+        g.drawText(juce::String(stats.repaintsLastFrame) + " repainted, "
+                       + juce::String(stats.hiddenLastFrame) + " hidden, "
+                       + juce::String(stats.deferredLastFrame) + " deferred of "
+                       + juce::String(stats.numClients),
+                   textArea.removeFromTop(12.0f), juce::Justification::left);
+    }
+
+private:
+    // Refresh a few times a second - fast enough to read, cheap enough not to skew the numbers
+    FrameScheduler::Client frameClient { this, [this] { frameClient.markDirty(); }, 6 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FrameTimeOverlay)
+};
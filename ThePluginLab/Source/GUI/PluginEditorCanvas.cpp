@@ -17,6 +17,10 @@ PluginEditorCanvas::PluginEditorCanvas()
     // Enable drag and drop
     setInterceptsMouseClicks(true, true);
     
+    // Wires are drawn over the nodes but leave mouse clicks to them
+    wireLayer.setAlwaysOnTop(true);
+    addAndMakeVisible(wireLayer);
+    
     // Initialize the processing graph
     processingGraph = std::make_unique<AudioProcessingGraph>();
 }
@@ -49,33 +53,118 @@ void PluginEditorCanvas::paint(juce::Graphics& g)
     {
         g.setColour(juce::Colours::white);
         
-        // Get the global position of the source point
-        juce::Point<float> startPoint = selectedSource->getBounds().getCentre().toFloat();
-        startPoint = selectedSource->localPointToGlobal(startPoint);
-        startPoint = getLocalPoint(nullptr, startPoint);
-        
-        // Draw the connection line
+        // Draw the connection line from the centre of the source point
+        auto startPoint = getConnectionDragStart();
         g.drawLine(startPoint.x, startPoint.y, dragEndPoint.x, dragEndPoint.y, 2.0f);
     }
 }
 
 void PluginEditorCanvas::resized()
 {
-    // Nothing to do here
+    wireLayer.setBounds(getLocalBounds());
+}
+
+void PluginEditorCanvas::childBoundsChanged(juce::Component* child)
+{
+    // When a node moves, only the wires attached to its ports follow it
+    if (auto* node = dynamic_cast<PluginNodeComponent*>(child))
+    {
+        for (int i = 0; i < node->getNumInputPorts(); ++i)
+            updateConnectionsForPort(node->getInputPort(i));
+            
+        for (int i = 0; i < node->getNumOutputPorts(); ++i)
+            updateConnectionsForPort(node->getOutputPort(i));
+    }
+}
+
+void PluginEditorCanvas::mouseDown(const juce::MouseEvent& e)
+{
+    // Right-click on a wire removes the connection
+    if (e.mods.isRightButtonDown())
+    {
+        if (auto* connection = wireLayer.findWireAt(e.position))
+            removeConnection(connection);
+    }
 }
 
 void PluginEditorCanvas::drawGrid(juce::Graphics& g, int gridSize)
 {
-    g.setColour(juce::Colours::white.withAlpha(Features::gridOpacity));
+    if (gridSize <= 0)
+        return;
+        
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
     
-    for (int x = 0; x < getWidth(); x += gridSize)
+    // Render a single grid cell at the display's pixel density, once per grid size and scale
+    if (! gridTile.isValid() || gridTileSize != gridSize || gridTileScale != scale)
     {
-        g.drawVerticalLine(x, 0.0f, static_cast<float>(getHeight()));
+        const int tilePixels = juce::jmax(1, juce::roundToInt(static_cast<float>(gridSize) * scale));
+        
+        gridTile = juce::Image(juce::Image::ARGB, tilePixels, tilePixels, true);
+        juce::Graphics tile(gridTile);
+        tile.addTransform(juce::AffineTransform::scale(static_cast<float>(tilePixels) / static_cast<float>(gridSize)));
+        tile.setColour(juce::Colours::white.withAlpha(Features::gridOpacity));
+        tile.drawVerticalLine(0, 0.0f, static_cast<float>(gridSize));
+        tile.drawHorizontalLine(0, 0.0f, static_cast<float>(gridSize));
+        
+        gridTileSize = gridSize;
+        gridTileScale = scale;
     }
     
-    for (int y = 0; y < getHeight(); y += gridSize)
+    // Tile it from the canvas origin over just the area being repainted
+    juce::Graphics::ScopedSaveState state(g);
+    g.setFillType(juce::FillType(gridTile, juce::AffineTransform::scale(static_cast<float>(gridSize) / static_cast<float>(gridTile.getWidth()))));
+    g.fillRect(g.getClipBounds());
+}
+
+juce::Point<float> PluginEditorCanvas::getConnectionDragStart() const
+{
+    return getLocalPoint(selectedSource, selectedSource->getLocalBounds().getCentre().toFloat());
+}
+
+juce::Rectangle<int> PluginEditorCanvas::getConnectionDragArea() const
+{
+    if (! isDraggingConnection || selectedSource == nullptr)
+        return {};
+        
+    // The line's bounds, padded for its thickness and anti-aliasing
+    return juce::Rectangle<float>(getConnectionDragStart(), dragEndPoint)
+               .expanded(2.0f)
+               .getSmallestIntegerContainer();
+}
+
+void PluginEditorCanvas::repaintConnectionDrag(const juce::Rectangle<int>& previousArea)
+{
+    // Only where the line was and where it is now, rather than the whole grid and every wire
+    repaint(previousArea);
+    repaint(getConnectionDragArea());
+}
+
+void PluginEditorCanvas::indexConnection(ConnectionComponent* connection)
+{
+    if (auto* source = connection->getSourcePoint())
+        connectionsByPort[source].add(connection);
+        
+    if (auto* dest = connection->getDestinationPoint())
+        connectionsByPort[dest].add(connection);
+        
+    wireLayer.addWire(*connection);
+}
+
+void PluginEditorCanvas::unindexConnection(ConnectionComponent* connection)
+{
+    wireLayer.removeWire(*connection);
+    
+    for (auto* port : { connection->getSourcePoint(), connection->getDestinationPoint() })
     {
-        g.drawHorizontalLine(y, 0.0f, static_cast<float>(getWidth()));
+        auto attached = connectionsByPort.find(port);
+        
+        if (attached == connectionsByPort.end())
+            continue;
+            
+        attached->second.removeFirstMatchingValue(connection);
+        
+        if (attached->second.isEmpty())
+            connectionsByPort.erase(attached);
     }
 }
 
@@ -83,13 +172,13 @@ void PluginEditorCanvas::addConnection(AudioConnectionPoint* source, AudioConnec
 {
     if (source != nullptr && destination != nullptr)
     {
-        // Create a new connection component
+        // Create a new connection, drawn by the wire layer
         auto* connection = new ConnectionComponent();
         connection->setSourcePoint(source);
         connection->setDestinationPoint(destination);
         
-        addAndMakeVisible(connection);
         connections.add(connection);
+        indexConnection(connection);
         
         // Update connected state
         source->setConnected(true);
@@ -98,8 +187,6 @@ void PluginEditorCanvas::addConnection(AudioConnectionPoint* source, AudioConnec
         // Notify listeners
         if (onConnectionMade)
             onConnectionMade(source, destination);
-            
-        repaint();
     }
 }
 
@@ -118,17 +205,20 @@ void PluginEditorCanvas::removeConnection(ConnectionComponent* connection)
         if (onConnectionRemoved)
             onConnectionRemoved(connection);
             
+        unindexConnection(connection);
         connections.removeObject(connection);
-        repaint();
     }
 }
 
 void PluginEditorCanvas::clear()
 {
     // Remove all connections
+    wireLayer.clear();
+    connectionsByPort.clear();
     connections.clear();
     
     // Remove all nodes
+    portIndex.clear();
     nodes.clear();
     
     // Reset state
@@ -266,6 +356,7 @@ void PluginEditorCanvas::loadFromProject(const juce::ValueTree& projectData)
                     
                     // Add to canvas
                     addAndMakeVisible(newNode.get());
+                    portIndex.addNode(*newNode);
                     nodes.add(newNode.release());
                 }
             }
@@ -426,10 +517,12 @@ void PluginEditorCanvas::startConnectionDrag(AudioConnectionPoint* startPoint)
 {
     if (startPoint != nullptr)
     {
+        auto previousArea = getConnectionDragArea();
+        
         selectedSource = startPoint;
         isDraggingConnection = true;
-        dragEndPoint = startPoint->getBounds().getCentre().toFloat();
-        repaint();
+        dragEndPoint = getConnectionDragStart();
+        repaintConnectionDrag(previousArea);
     }
 }
 
@@ -437,8 +530,10 @@ void PluginEditorCanvas::dragConnection(AudioConnectionPoint* source, const juce
 {
     if (isDraggingConnection && source == selectedSource)
     {
+        auto previousArea = getConnectionDragArea();
+        
         dragEndPoint = getLocalPoint(nullptr, mousePos);
-        repaint();
+        repaintConnectionDrag(previousArea);
     }
 }
 
@@ -472,9 +567,11 @@ void PluginEditorCanvas::endConnectionDrag()
         }
         
         // Reset connection state
+        auto previousArea = getConnectionDragArea();
+        
         isDraggingConnection = false;
         selectedSource = nullptr;
-        repaint();
+        repaintConnectionDrag(previousArea);
     }
 }
 
@@ -483,60 +580,20 @@ void PluginEditorCanvas::updateConnectionsForPort(AudioConnectionPoint* port)
     if (port == nullptr)
         return;
         
-    // Find all connections that use this port
-    for (auto* connection : connections)
-    {
-        if (connection->getSourcePoint() == port || connection->getDestinationPoint() == port)
-        {
-            connection->updatePosition();
-        }
-    }
+    // Only the connections attached to this port
+    auto attached = connectionsByPort.find(port);
+    
+    if (attached == connectionsByPort.end())
+        return;
+    
+    for (auto* connection : attached->second)
+        wireLayer.updateWire(*connection);
 }
 
 AudioConnectionPoint* PluginEditorCanvas::findPortAt(const juce::Point<int>& screenPosition, const AudioConnectionPoint* excludePort)
 {
-    // Convert screen position to local coordinates for each node
-    for (auto* node : nodes)
-    {
-        if (node == nullptr)
-            continue;
-            
-        // Check input ports
-        for (int i = 0; i < 10; i++) // Assuming a reasonable maximum number of ports
-        {
-            auto* port = node->getInputPort(i);
-            if (port != nullptr && port != excludePort)
-            {
-                // Convert port bounds to screen coordinates
-                juce::Rectangle<int> portBounds = port->getScreenBounds();
-                
-                // Check if the position is within the port bounds
-                if (portBounds.contains(screenPosition))
-                {
-                    return port;
-                }
-            }
-        }
-        
-        // Check output ports
-        for (int i = 0; i < 10; i++) // Assuming a reasonable maximum number of ports
-        {
-            auto* port = node->getOutputPort(i);
-            if (port != nullptr && port != excludePort)
-            {
-                // Convert port bounds to screen coordinates
-                juce::Rectangle<int> portBounds = port->getScreenBounds();
-                
-                // Check if the position is within the port bounds
-                if (portBounds.contains(screenPosition))
-                {
-                    return port;
-                }
-            }
-        }
-    }
-    
-    return nullptr;
+    // Only the ports in the grid cell under the point are tested
+    return portIndex.findPortAt(getLocalPoint(nullptr, screenPosition), excludePort);
 }
 
 void PluginEditorCanvas::disconnectPort(AudioConnectionPoint* port)
@@ -544,19 +601,30 @@ void PluginEditorCanvas::disconnectPort(AudioConnectionPoint* port)
     if (port == nullptr)
         return;
         
-    // Find all connections that use this port
-    for (int i = connections.size() - 1; i >= 0; --i)
+    auto attached = connectionsByPort.find(port);
+    
+    if (attached != connectionsByPort.end())
     {
-        auto* connection = connections[i];
+        // Copied, as unindexing each connection edits the map
+        auto portConnections = attached->second;
         
-        if (connection->getSourcePoint() == port || connection->getDestinationPoint() == port)
+        for (auto* connection : portConnections)
         {
             // Notify listeners before removing
             if (onConnectionRemoved)
                 onConnectionRemoved(connection);
                 
             // Remove the connection
-            connections.remove(i);
+            unindexConnection(connection);
+            
+            // The far end stays connected only if other wires still reach it
+            auto* otherPort = connection->getSourcePoint() == port ? connection->getDestinationPoint()
+                                                                   : connection->getSourcePoint();
+            
+            if (otherPort != nullptr && connectionsByPort.find(otherPort) == connectionsByPort.end())
+                otherPort->setConnected(false);
+                
+            connections.removeObject(connection);
         }
     }
     
@@ -573,6 +641,7 @@ void PluginEditorCanvas::addNode(std::unique_ptr<ConcretePluginNode> node)
         // Add the node to the canvas
         addAndMakeVisible(node.get());
         PluginNodeComponent* nodePtr = node.get();
+        portIndex.addNode(*nodePtr);
         nodes.add(node.release());
         
         // Notify listeners
@@ -589,7 +658,25 @@ void PluginEditorCanvas::removeNode(ConcretePluginNode* node)
         if (onNodeRemoved)
             onNodeRemoved(node);
         
+        // Drop every wire on the node's ports first, or the connections and the
+        // port map would keep pointers to ports deleted along with the node
+        for (int i = 0; i < node->getNumInputPorts(); ++i)
+            disconnectPort(node->getInputPort(i));
+            
+        for (int i = 0; i < node->getNumOutputPorts(); ++i)
+            disconnectPort(node->getOutputPort(i));
+            
+        // A connection drag can't outlive the port it started from
+        if (selectedSource != nullptr && node->isParentOf(selectedSource))
+        {
+            auto previousArea = getConnectionDragArea();
+            isDraggingConnection = false;
+            selectedSource = nullptr;
+            repaintConnectionDrag(previousArea);
+        }
+        
         // Remove the node from the canvas
+        portIndex.removeNode(*node);
         nodes.removeObject(node);
     }
 }
@@ -2,6 +2,9 @@
 #include <JuceHeader.h>
 #include "../Common/Types.h"
 #include "../Common/Features.h"
+#include "PortSpatialIndex.h"
+#include "WireLayer.h"
+#include <unordered_map>
 
 // Forward declarations to avoid circular dependencies
 class AudioConnectionPoint;
@@ -26,6 +29,8 @@ public:
     // Component overrides
     void paint(juce::Graphics& g) override;
     void resized() override;
+    void childBoundsChanged(juce::Component* child) override;
+    void mouseDown(const juce::MouseEvent& e) override;
     
     // Node management
     void addNode(std::unique_ptr<ConcretePluginNode> node);
@@ -34,6 +39,7 @@ public:
     // Connection management
     void addConnection(AudioConnectionPoint* source, AudioConnectionPoint* destination);
     void removeConnection(ConnectionComponent* connection);
+    int getNumConnections() const { return connections.size(); }
     
     // Connection dragging handlers
     void startConnectionDrag(AudioConnectionPoint* startPoint);
@@ -68,6 +74,15 @@ private:
     // Helper method
     void drawGrid(juce::Graphics& g, int gridSize);
     
+    // Connection drag preview geometry, in canvas coordinates
+    juce::Point<float> getConnectionDragStart() const;
+    juce::Rectangle<int> getConnectionDragArea() const;
+    void repaintConnectionDrag(const juce::Rectangle<int>& previousArea);
+    
+    // Keep connectionsByPort and the wire layer in step with connections
+    void indexConnection(ConnectionComponent* connection);
+    void unindexConnection(ConnectionComponent* connection);
+    
     // Nodes
     juce::OwnedArray<ConcretePluginNode> nodes;
     juce::OwnedArray<GuiNode> guiNodes;
@@ -77,16 +92,32 @@ private:
     // Connections
     juce::OwnedArray<ConnectionComponent> connections;
     
+    // The connections attached to each port, so moving a node only touches its own wires
+    std::unordered_map<AudioConnectionPoint*, juce::Array<ConnectionComponent*>> connectionsByPort;
+    
+    // Port hit-testing for connection drags, kept up to date as nodes move
+    PortSpatialIndex portIndex { *this };
+    
+    // Draws all connections, above the nodes
+    WireLayer wireLayer;
+    
     // Connection drag state
     bool isDraggingConnection = false;
     AudioConnectionPoint* selectedSource = nullptr;
     juce::Point<float> dragEndPoint;
     
+    // One cell of the background grid, rendered at the display scale and tiled by drawGrid
+    juce::Image gridTile;
+    int gridTileSize = 0;
+    float gridTileScale = 0.0f;
+    
     // Audio processing graph
     std::unique_ptr<AudioProcessingGraph> processingGraph;
     
     // UI state
     bool showTutorialOverlay = true;
     
+    friend class CanvasDiagnostics;
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginEditorCanvas)
 };
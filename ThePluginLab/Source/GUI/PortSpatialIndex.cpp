@@ -0,0 +1,154 @@
+#include "PortSpatialIndex.h"
+#include <algorithm>
+#include "../Connections/AudioConnectionPoint.h"
+#include "../Components/PluginNodeComponent.h"
+
+PortSpatialIndex::PortSpatialIndex(juce::Component& canvasToIndex, int cellSizeToUse)
+    : canvas(canvasToIndex), cellSize(juce::jmax(8, cellSizeToUse))
+{
+}
+
+PortSpatialIndex::~PortSpatialIndex()
+{
+    clear();
+}
+
+void PortSpatialIndex::addNode(PluginNodeComponent& node)
+{
+    jassert(node.getParentComponent() == &canvas);
+
+    if (nodes.find(&node) != nodes.end())
+        return;
+
+    auto& entry = nodes[&node];
+    entry.node = &node;
+    indexPorts(entry);
+
+    node.addComponentListener(this);
+}
+
+void PortSpatialIndex::removeNode(PluginNodeComponent& node)
+{
+    auto it = nodes.find(&node);
+
+    if (it == nodes.end())
+        return;
+
+    node.removeComponentListener(this);
+    unindexPorts(it->second);
+    nodes.erase(it);
+}
+
+void PortSpatialIndex::clear()
+{
+    for (auto& entry : nodes)
+        entry.first->removeComponentListener(this);
+
+    nodes.clear();
+    cells.clear();
+}
+
+AudioConnectionPoint* PortSpatialIndex::findPortAt(juce::Point<int> canvasPosition, const AudioConnectionPoint* excludePort) const
+{
+    auto cell = cells.find(getCellKey(getCell(canvasPosition.x), getCell(canvasPosition.y)));
+
+    if (cell == cells.end())
+        return nullptr;
+
+    for (const auto& indexed : cell->second)
+        if (indexed.port != excludePort && indexed.bounds.contains(canvasPosition))
+            return indexed.port;
+
+    return nullptr;
+}
+
+void PortSpatialIndex::indexPorts(IndexedNode& entry)
+{
+    auto& node = *entry.node;
+
+    auto addPort = [this, &entry] (AudioConnectionPoint* port)
+    {
+        if (port == nullptr || ! port->isVisible())
+            return;
+
+        const IndexedPort indexed { port, canvas.getLocalArea(port, port->getLocalBounds()) };
+        entry.ports.push_back(indexed);
+
+        for (int y = getCell(indexed.bounds.getY()); y <= getCell(indexed.bounds.getBottom() - 1); ++y)
+            for (int x = getCell(indexed.bounds.getX()); x <= getCell(indexed.bounds.getRight() - 1); ++x)
+                cells[getCellKey(x, y)].push_back(indexed);
+    };
+
+    for (int i = 0; i < node.getNumInputPorts(); ++i)
+        addPort(node.getInputPort(i));
+
+    for (int i = 0; i < node.getNumOutputPorts(); ++i)
+        addPort(node.getOutputPort(i));
+}
+
+void PortSpatialIndex::unindexPorts(IndexedNode& entry)
+{
+    for (const auto& indexed : entry.ports)
+    {
+        for (int y = getCell(indexed.bounds.getY()); y <= getCell(indexed.bounds.getBottom() - 1); ++y)
+        {
+            for (int x = getCell(indexed.bounds.getX()); x <= getCell(indexed.bounds.getRight() - 1); ++x)
+            {
+                auto cell = cells.find(getCellKey(x, y));
+
+                if (cell == cells.end())
+                    continue;
+
+                auto& cellPorts = cell->second;
+                cellPorts.erase(std::remove_if(cellPorts.begin(), cellPorts.end(),
+                                               [&indexed] (const IndexedPort& p) { return p.port == indexed.port; }),
+                                cellPorts.end());
+
+                if (cellPorts.empty())
+                    cells.erase(cell);
+            }
+        }
+    }
+
+    entry.ports.clear();
+}
+
+int PortSpatialIndex::getCell(int coordinate) const noexcept
+{
+    // Rounds towards negative infinity, so nodes dragged above or left of the origin still index correctly
+    return coordinate >= 0 ? coordinate / cellSize : -((-coordinate + cellSize - 1) / cellSize);
+}
+
+juce::int64 PortSpatialIndex::getCellKey(int cellX, int cellY) noexcept
+{
+    return (juce::int64) (((juce::uint64) (juce::uint32) cellX << 32) | (juce::uint32) cellY);
+}
+
+void PortSpatialIndex::componentMovedOrResized(juce::Component& component, bool, bool)
+{
+    // Resizing a node lays its ports out again, so either way they are all re-indexed
+    auto it = nodes.find(&component);
+
+    if (it != nodes.end())
+    {
+        unindexPorts(it->second);
+        indexPorts(it->second);
+    }
+}
+
+void PortSpatialIndex::componentChildrenChanged(juce::Component& component)
+{
+    // Ports added or removed after the node was indexed
+    componentMovedOrResized(component, false, false);
+}
+
+void PortSpatialIndex::componentBeingDeleted(juce::Component& component)
+{
+    auto it = nodes.find(&component);
+
+    if (it != nodes.end())
+    {
+        unindexPorts(it->second);
+        nodes.erase(it);
+    }
+}
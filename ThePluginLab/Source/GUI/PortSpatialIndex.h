@@ -0,0 +1,63 @@
+#pragma once
+#include <JuceHeader.h>
+#include <unordered_map>
+#include <vector>
+
+class AudioConnectionPoint;
+class PluginNodeComponent;
+
+/**
+ * Uniform-grid index of the connection ports on a canvas, for hit-testing.
+ *
+ * Each port's bounds, in canvas coordinates, are stored in every grid cell they
+ * overlap. A hit test only looks at the few ports in the cell under the point,
+ * so it costs the same however many nodes the canvas holds. The index listens to
+ * its nodes and re-indexes a node's ports when it moves, is resized or gains or
+ * loses child components.
+ */
+class PortSpatialIndex : private juce::ComponentListener
+{
+public:
+    explicit PortSpatialIndex(juce::Component& canvasToIndex, int cellSizeToUse = 64);
+    ~PortSpatialIndex() override;
+
+    // Nodes must be children of the canvas
+    void addNode(PluginNodeComponent& node);
+    void removeNode(PluginNodeComponent& node);
+    void clear();
+
+    // The port containing a point in canvas coordinates, or nullptr
+    AudioConnectionPoint* findPortAt(juce::Point<int> canvasPosition, const AudioConnectionPoint* excludePort = nullptr) const;
+
+private:
+    struct IndexedPort
+    {
+        AudioConnectionPoint* port = nullptr;
+        juce::Rectangle<int> bounds;
+    };
+
+    struct IndexedNode
+    {
+        PluginNodeComponent* node = nullptr;
+        std::vector<IndexedPort> ports;
+    };
+
+    void indexPorts(IndexedNode& entry);
+    void unindexPorts(IndexedNode& entry);
+
+    int getCell(int coordinate) const noexcept;
+    static juce::int64 getCellKey(int cellX, int cellY) noexcept;
+
+    // ComponentListener
+    void componentMovedOrResized(juce::Component& component, bool wasMoved, bool wasResized) override;
+    void componentChildrenChanged(juce::Component& component) override;
+    void componentBeingDeleted(juce::Component& component) override;
+
+    juce::Component& canvas;
+    const int cellSize;
+
+    std::unordered_map<juce::Component*, IndexedNode> nodes;
+    std::unordered_map<juce::int64, std::vector<IndexedPort>> cells;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PortSpatialIndex)
+};
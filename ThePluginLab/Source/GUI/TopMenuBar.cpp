@@ -68,6 +68,8 @@ juce::PopupMenu TopMenuBar::getMenuForIndex(int /*index*/, const juce::String& n
         menu.addItem(4, "Save As...");
         menu.addSeparator();
         menu.addItem(5, "Export Plugin...");
+        menu.addSeparator();
+        menu.addItem(6, "Audio Settings...");
     }
     else if (name == "Templates")
     {
@@ -96,6 +98,7 @@ void TopMenuBar::menuItemSelected(int menuItemID, int /*topLevelMenuIndex*/)
         case 3: if (onSaveProject) onSaveProject(); break;
         case 4: if (onSaveProjectAs) onSaveProjectAs(); break;
         case 5: if (onExportPlugin) onExportPlugin(); break;
+        case 6: if (onAudioSettings) onAudioSettings(); break;
         
         case 101: if (onLoadTemplate) onLoadTemplate("Basic EQ"); break;
         case 102: if (onLoadTemplate) onLoadTemplate("Basic Compressor"); break;
@@ -27,6 +27,7 @@ public:
     std::function<void()> onSaveProject;
     std::function<void()> onSaveProjectAs;
     std::function<void()> onExportPlugin;
+    std::function<void()> onAudioSettings;
     std::function<void(const juce::String&)> onLoadTemplate;
     std::function<void(const juce::String&)> onStartTutorial;
     std::function<void(bool)> onShowTips;
@@ -1,5 +1,7 @@
 #pragma once
 #include <JuceHeader.h>
+#include "FrameScheduler.h"
+#include "PluginEditorCanvas.h"
 
 /**
  * Helper class to show tutorial overlays for new users
@@ -10,11 +12,12 @@ public:
     TutorialHelper()
     {
         setInterceptsMouseClicks(false, false);
-        startTimer(100); // Check periodically for tutorial needs
     }
     
     void paint(juce::Graphics& g) override
     {
+        FrameScheduler::Client::ScopedPaintTimer paintTimer(frameClient);
+        
         if (!isVisible())
             return;
             
@@ -28,11 +31,6 @@ public:
             drawParametersTip(g);
     }
     
-    void timerCallback()
-    {
-        checkTutorialState();
-    }
-    
     void mouseDown(const juce::MouseEvent& e) override
     {
         // Dismiss current tip
@@ -47,6 +45,9 @@ public:
     }
     
 private:
+    // Check periodically for tutorial needs - every 6th frame, roughly 10 Hz
+    FrameScheduler::Client frameClient { this, [this] { checkTutorialState(); }, 6 };
+    
     bool shouldShowComponentPanelTip = true;
     bool shouldShowConnectionTip = false;
     bool shouldShowParametersTip = false;
@@ -59,17 +60,19 @@ private:
             
         // Check for nodes on canvas
         int nodeCount = 0;
-        int connectionCount = 0;
         
         for (auto* child : parent->getChildren())
         {
             if (dynamic_cast<PluginNodeComponent*>(child) != nullptr)
                 nodeCount++;
-                
-            if (dynamic_cast<ConnectionComponent*>(child) != nullptr)
-                connectionCount++;
         }
         
+        // Connections are drawn by the canvas's wire layer rather than being children
+        auto* canvas = dynamic_cast<PluginEditorCanvas*>(parent);
+        int connectionCount = canvas != nullptr ? canvas->getNumConnections() : 0;
+        
+        auto previousState = std::make_tuple(shouldShowComponentPanelTip, shouldShowConnectionTip, shouldShowParametersTip);
+        
         // Show connection tip after first node is added
         if (nodeCount > 0 && connectionCount == 0)
         {
@@ -85,7 +88,9 @@ private:
             shouldShowParametersTip = true;
         }
         
-        repaint();
+        // Only repaint when the tip actually changes
+        if (previousState != std::make_tuple(shouldShowComponentPanelTip, shouldShowConnectionTip, shouldShowParametersTip))
+            frameClient.markDirty();
     }
     
     void drawComponentPanelTip(juce::Graphics& g)
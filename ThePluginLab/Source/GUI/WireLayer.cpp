@@ -0,0 +1,166 @@
+#include "WireLayer.h"
+#include "../Connections/AudioConnectionPoint.h"
+#include "../Connections/ConnectionComponent.h"
+
+WireLayer::WireLayer()
+{
+    setInterceptsMouseClicks(false, false);
+}
+
+void WireLayer::addWire(ConnectionComponent& connection)
+{
+    if (wireIndices.find(&connection) != wireIndices.end())
+        return;
+
+    Wire wire;
+    wire.connection = &connection;
+    computeGeometry(wire);
+
+    wireIndices[&connection] = wires.size();
+    wires.push_back(wire);
+
+    repaintWire(wire);
+}
+
+void WireLayer::removeWire(ConnectionComponent& connection)
+{
+    auto it = wireIndices.find(&connection);
+
+    if (it == wireIndices.end())
+        return;
+
+    const auto index = it->second;
+    repaintWire(wires[index]);
+
+    // Swap the last wire into the gap, keeping the array packed
+    if (index != wires.size() - 1)
+    {
+        wires[index] = wires.back();
+        wireIndices[wires[index].connection] = index;
+    }
+
+    wires.pop_back();
+    wireIndices.erase(it);
+}
+
+void WireLayer::clear()
+{
+    wires.clear();
+    wireIndices.clear();
+    repaint();
+}
+
+void WireLayer::updateWire(ConnectionComponent& connection)
+{
+    auto it = wireIndices.find(&connection);
+
+    if (it == wireIndices.end())
+        return;
+
+    auto& wire = wires[it->second];
+    const auto previous = wire;
+
+    if (computeGeometry(wire))
+    {
+        repaintWire(previous);
+        repaintWire(wire);
+    }
+}
+
+ConnectionComponent* WireLayer::findWireAt(juce::Point<float> position, float tolerance) const
+{
+    const auto maxDistance = tolerance + lineThickness * 0.5f;
+
+    // Last added is drawn on top
+    for (auto it = wires.rbegin(); it != wires.rend(); ++it)
+    {
+        if (! it->isValid || ! it->bounds.expanded(tolerance).contains(position))
+            continue;
+
+        juce::Path path;
+        path.startNewSubPath(it->start);
+        path.cubicTo(it->control1, it->control2, it->end);
+
+        juce::Point<float> nearest;
+        path.getNearestPoint(position, nearest);
+
+        if (nearest.getDistanceFrom(position) <= maxDistance)
+            return it->connection;
+    }
+
+    return nullptr;
+}
+
+void WireLayer::paint(juce::Graphics& g)
+{
+    const auto clip = g.getClipBounds().toFloat();
+
+    // Every wire in the clip region goes into one path, stroked once
+    juce::Path batch;
+
+    for (const auto& wire : wires)
+    {
+        if (! wire.isValid || ! wire.bounds.intersects(clip))
+            continue;
+
+        batch.startNewSubPath(wire.start);
+        batch.cubicTo(wire.control1, wire.control2, wire.end);
+    }
+
+    if (batch.isEmpty())
+        return;
+
+    g.setColour(juce::Colours::white);
+    g.strokePath(batch, juce::PathStrokeType(lineThickness));
+}
+
+bool WireLayer::computeGeometry(Wire& wire) const
+{
+    auto* source = wire.connection->getSourcePoint();
+    auto* destination = wire.connection->getDestinationPoint();
+
+    if (source == nullptr || destination == nullptr)
+    {
+        const auto changed = wire.isValid;
+        wire.isValid = false;
+        return changed;
+    }
+
+    const auto start = getLocalPoint(source, source->getLocalBounds().getCentre().toFloat());
+    const auto end = getLocalPoint(destination, destination->getLocalBounds().getCentre().toFloat());
+
+    if (wire.isValid && start == wire.start && end == wire.end)
+        return false;
+
+    // The curve bends based on the horizontal distance
+    const auto bezierOffset = juce::jmin(50.0f, std::abs(end.x - start.x) * 0.5f);
+
+    wire.start = start;
+    wire.end = end;
+    wire.control1 = { start.x + bezierOffset, start.y };
+    wire.control2 = { end.x - bezierOffset, end.y };
+
+    // A cubic lies inside the hull of its control points
+    wire.bounds = juce::Rectangle<float>(wire.start, wire.end)
+                      .getUnion(juce::Rectangle<float>(wire.control1, wire.control2))
+                      .expanded(lineThickness);
+    wire.isValid = true;
+
+    return true;
+}
+
+void WireLayer::repaintWire(const Wire& wire)
+{
+    if (! wire.isValid)
+        return;
+
+    const auto area = wire.bounds.getSmallestIntegerContainer();
+
+    if (repaintRecorder != nullptr)
+    {
+        repaintRecorder->add(area);
+        ++numRepaintRequests;
+    }
+
+    repaint(area);
+}
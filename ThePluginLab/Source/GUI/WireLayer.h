@@ -0,0 +1,63 @@
+#pragma once
+#include <JuceHeader.h>
+#include <unordered_map>
+#include <vector>
+
+class ConnectionComponent;
+
+/**
+ * Draws every connection on a canvas from one overlay component.
+ *
+ * The bezier geometry and bounds of each wire are cached in a flat array and
+ * only recomputed by updateWire(), which the canvas calls for the wires whose
+ * ports moved. paint() gathers the wires that touch the clip region into a
+ * single path and strokes it once, so adding connections adds no components and
+ * no paint calls. The layer is transparent to the mouse; the canvas uses
+ * findWireAt() to hit-test wires itself.
+ */
+class WireLayer : public juce::Component
+{
+public:
+    WireLayer();
+
+    void addWire(ConnectionComponent& connection);
+    void removeWire(ConnectionComponent& connection);
+    void clear();
+
+    // Recomputes a wire after one of its ports moved, repainting the area it left and entered
+    void updateWire(ConnectionComponent& connection);
+
+    // The topmost wire passing within tolerance of a point in layer coordinates, or nullptr
+    ConnectionComponent* findWireAt(juce::Point<float> position, float tolerance = 4.0f) const;
+
+    int getNumWires() const noexcept { return (int) wires.size(); }
+
+    // Component overrides
+    void paint(juce::Graphics& g) override;
+
+private:
+    struct Wire
+    {
+        ConnectionComponent* connection = nullptr;
+        juce::Point<float> start, control1, control2, end;
+        juce::Rectangle<float> bounds;
+        bool isValid = false;
+    };
+
+    // Returns true if the geometry changed
+    bool computeGeometry(Wire& wire) const;
+    void repaintWire(const Wire& wire);
+
+    std::vector<Wire> wires;
+    std::unordered_map<ConnectionComponent*, size_t> wireIndices;
+
+    // When set, every area repaintWire() asks for is also added here
+    juce::RectangleList<int>* repaintRecorder = nullptr;
+    int numRepaintRequests = 0;
+
+    static constexpr float lineThickness = 2.0f;
+
+    friend class CanvasDiagnostics;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WireLayer)
+};
@@ -1,6 +1,10 @@
 #include <JuceHeader.h>
 #include "MainComponent.h"
 #include "Common/ExceptionHandler.h"
+#include "Visualizers/VisualizerRenderHarness.h"
+#include "Visualizers/VisualizerDiagnostics.h"
+#include "Audio/Graphs/GraphDiagnostics.h"
+#include "GUI/CanvasDiagnostics.h"
 
 // This class handles the application shutdown to prevent DisplayLink crashes
 class SafeApplicationShutdown
@@ -26,6 +30,38 @@ public:
         // Install exception handlers
         ExceptionHandler::installExceptionHandlers();
         
+        // Headless mode for CI - render the visualizers offscreen, print the report and exit
+        if (commandLine.contains("--render-visualizers"))
+        {
+            setApplicationReturnValue(VisualizerRenderHarness::runFromCommandLine(commandLine));
+            quit();
+            return;
+        }
+        
+        // Headless visualizer accuracy checks for CI
+        if (VisualizerDiagnostics::handlesCommandLine(commandLine))
+        {
+            setApplicationReturnValue(VisualizerDiagnostics::runFromCommandLine(commandLine));
+            quit();
+            return;
+        }
+        
+        // Headless audio graph checks for CI
+        if (GraphDiagnostics::handlesCommandLine(commandLine))
+        {
+            setApplicationReturnValue(GraphDiagnostics::runFromCommandLine(commandLine));
+            quit();
+            return;
+        }
+        
+        // Headless canvas benchmarks for CI
+        if (CanvasDiagnostics::handlesCommandLine(commandLine))
+        {
+            setApplicationReturnValue(CanvasDiagnostics::runFromCommandLine(commandLine));
+            quit();
+            return;
+        }
+        
         // Create main window
         mainWindow.reset(new MainWindow(getApplicationName()));
     }
@@ -48,7 +84,8 @@ public:
     void anotherInstanceStarted(const juce::String& commandLine) override
     {
         // Focus this instance if another one starts
-        mainWindow->toFront(true);
+        if (mainWindow != nullptr)
+            mainWindow->toFront(true);
     }
     
     class MainWindow : public juce::DocumentWindow
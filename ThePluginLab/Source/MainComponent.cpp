@@ -22,12 +22,20 @@ MainComponent::MainComponent()
     topMenuBar->onNewProject = [this]() { newProject(); };
     topMenuBar->onOpenProject = [this]() { openProject(); };
     topMenuBar->onSaveProject = [this]() { saveProject(); };
+    topMenuBar->onAudioSettings = [this]() { showAudioSettings(); };
     
     toolPalette->onToolSelected = [this](ComponentType type) {
         // Handle tool selection
         currentTool = type;
     };
     
+    // Play the canvas's graph, timing every callback against its deadline. The device
+    // itself is only opened from the audio settings, so launching never starts audio
+    // or asks for microphone access.
+    graphPlayer.setGraph(canvas->getProcessingGraph());
+    audioCallbackLoadMeter.setCallbackToMeasure(&graphPlayer);
+    deviceManager.addAudioCallback(&audioCallbackLoadMeter);
+    
     // Configure window
     setSize(1200, 800);
     setWantsKeyboardFocus(true);
@@ -35,7 +43,15 @@ MainComponent::MainComponent()
 
 MainComponent::~MainComponent()
 {
-    // Clean up resources
+    // The settings window refers to the device manager, so it can't outlive it
+    if (audioSettingsWindow != nullptr)
+        delete audioSettingsWindow.getComponent();
+    
+    // Stop audio before the canvas and its graph are destroyed
+    deviceManager.removeAudioCallback(&audioCallbackLoadMeter);
+    deviceManager.closeAudioDevice();
+    audioCallbackLoadMeter.setCallbackToMeasure(nullptr);
+    graphPlayer.setGraph(nullptr);
 }
 
 void MainComponent::paint(juce::Graphics& g)
@@ -79,6 +95,38 @@ void MainComponent::exportPlugin()
                                          "Plugin export functionality will be implemented soon.");
 }
 
+void MainComponent::showAudioSettings()
+{
+    if (audioSettingsWindow != nullptr)
+    {
+        audioSettingsWindow->toFront(true);
+        return;
+    }
+    
+    // First use: the default output only. Inputs stay off until chosen in the selector.
+    if (deviceManager.getCurrentAudioDevice() == nullptr)
+    {
+        auto audioError = deviceManager.initialiseWithDefaultDevices(0, 2);
+        
+        if (audioError.isNotEmpty())
+            DBG("MainComponent: couldn't open an audio device: " << audioError);
+    }
+    
+    auto selector = std::make_unique<juce::AudioDeviceSelectorComponent>(deviceManager, 0, 2, 0, 2,
+                                                                          false, false, true, false);
+    selector->setSize(500, 400);
+    
+    juce::DialogWindow::LaunchOptions options;
+    options.content.setOwned(selector.release());
+    options.dialogTitle = "Audio Settings";
+    options.dialogBackgroundColour = Features::backgroundColor;
+    options.escapeKeyTriggersCloseButton = true;
+    options.useNativeTitleBar = true;
+    options.resizable = false;
+    options.componentToCentreAround = this;
+    audioSettingsWindow = options.launchAsync();
+}
+
 void MainComponent::newProject()
 {
     // Create new project
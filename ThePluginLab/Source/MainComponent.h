@@ -7,6 +7,8 @@
 #include "GUI/PluginEditorCanvas.h"
 #include "GUI/ComponentPanel.h"
 #include "Common/Features.h"
+#include "Audio/AudioCallbackLoadMeter.h"
+#include "Audio/Graphs/AudioGraphPlayer.h"
 
 class PluginEditorCanvas;
 
@@ -22,6 +24,9 @@ public:
     void paint(juce::Graphics& g) override;
     void resized() override;
     
+    // Callback load and xrun statistics for the app's audio callback
+    AudioCallbackLoadMeter& getAudioCallbackLoadMeter() { return audioCallbackLoadMeter; }
+    
 private:
     // Project management functions
     void exportPlugin();
@@ -31,6 +36,9 @@ private:
     void saveProjectToFile(const juce::File& file);
     void loadProject(const juce::File& file);
     
+    // Opens the audio device on first use and shows the device settings
+    void showAudioSettings();
+    
     // Main components
     std::unique_ptr<TopMenuBar> topMenuBar;
     std::unique_ptr<ToolPalette> toolPalette;
@@ -46,5 +54,12 @@ private:
     // Logo
     juce::Image logo;
     
+    // Audio: the canvas's graph is played through the load meter, so every callback is timed.
+    // No device is opened until the user asks for one from the audio settings.
+    juce::AudioDeviceManager deviceManager;
+    AudioGraphPlayer graphPlayer;
+    AudioCallbackLoadMeter audioCallbackLoadMeter;
+    juce::Component::SafePointer<juce::DialogWindow> audioSettingsWindow;
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainComponent)
 };
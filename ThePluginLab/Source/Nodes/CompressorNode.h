@@ -25,6 +25,8 @@ public:
     // Port accessor implementations
     AudioConnectionPoint* getInputPort(int index) const override;
     AudioConnectionPoint* getOutputPort(int index) const override;
+    int getNumInputPorts() const override { return inputPorts.size(); }
+    int getNumOutputPorts() const override { return outputPorts.size(); }
     
     // Compressor-specific methods
     void setThreshold(float threshold);
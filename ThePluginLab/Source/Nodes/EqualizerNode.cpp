@@ -284,8 +284,9 @@ void EqualizerNode::updateControls()
 void EqualizerNode::updateFilter()
 {
     // In a real implementation, this would update the audio processing filter
-    // For the prototype, we'll just update the UI
+    // For the prototype, we update the UI and tell response displays to redraw
     repaint();
+    sendChangeMessage();
 }
 
 void EqualizerNode::showHelpPopup()
@@ -6,8 +6,12 @@
 /**
  * GUI node representing an equalizer effect in The Plugin Lab
  * This is a simplified prototype focused on the user interface
+ *
+ * Sends a change message whenever a band's settings change, so response
+ * curves can redraw only then.
  */
 class EqualizerNode : public juce::Component,
+                     public juce::ChangeBroadcaster,
                      public juce::Slider::Listener,
                      public juce::ComboBox::Listener,
                      public juce::Button::Listener
@@ -39,6 +43,9 @@ public:
     void setSelectedBand(int bandIndex);
     int getSelectedBand() const { return selectedBand; }
     
+    // Band settings and coefficients, for response displays
+    const EQProcessor& getEQProcessor() const { return eqProcessor; }
+    
 private:
     // UI components
     juce::Slider frequencySlider;
@@ -1,27 +1,36 @@
 #include "AudioVisualizer.h"
+#include "../Audio/Graphs/DenormalProtection.h"
 
 AudioVisualizer::AudioVisualizer()
     : fft(fftOrder),
       fftData(fftSize * 2),
-      fftWindow(fftSize)
+      sideFftData(fftSize * 2),
+      fftWindow(fftSize),
+      waveformScratch((size_t) fftSize * 2)
 {
     setOpaque(true);
-    startTimerHz(60); // 60 fps refresh rate
     
     for (int i = 0; i < fftSize; ++i)
         fftWindow[i] = 0.5f - 0.5f * std::cos(2.0f * juce::MathConstants<float>::pi * i / (fftSize - 1));
+    
+    for (auto& scratch : channelScratch)
+        scratch.resize((size_t) captureBuffer.getCapacity() / SIMDFloat::SIMDNumElements);
+    
+    analysisThread.startThread();
 }
 
 AudioVisualizer::~AudioVisualizer()
 {
-    stopTimer();
+    analysisThread.stopThread(1000);
 }
 
 void AudioVisualizer::paint(juce::Graphics& g)
 {
+    FrameScheduler::Client::ScopedPaintTimer paintTimer(frameClient);
+    
     g.fillAll(juce::Colours::black);
     
-    switch (visualizationType)
+    switch (visualizationType.load())
     {
         case VisualizationType::Waveform:
             drawWaveform(g);
@@ -32,6 +41,12 @@ void AudioVisualizer::paint(juce::Graphics& g)
         case VisualizationType::EQResponse:
             drawEQResponse(g);
             break;
+        case VisualizationType::MidSideSpectrum:
+            drawMidSideSpectrum(g);
+            break;
+        case VisualizationType::Goniometer:
+            drawGoniometer(g);
+            break;
     }
 }
 
@@ -40,41 +55,224 @@ void AudioVisualizer::pushBuffer(const juce::AudioBuffer<float>& buffer)
     auto* channelData = buffer.getReadPointer(0);
     int numSamples = buffer.getNumSamples();
     
+    float level = maxLevel.load(std::memory_order_relaxed);
+    
     for (int i = 0; i < numSamples; ++i)
     {
         float absLevel = std::abs(channelData[i]);
-        maxLevel = juce::jmax(maxLevel * 0.99f, absLevel);
+        level = juce::jmax(level * 0.99f, absLevel);
     }
     
-    for (int i = 0; i < numSamples; ++i)
+    maxLevel.store(level, std::memory_order_relaxed);
+    
+    // Every channel goes into the ring; the stereo-field analysis reads them in pairs
+    numCapturedChannels.store(juce::jlimit(1, maxChannels, buffer.getNumChannels()), std::memory_order_relaxed);
+    captureBuffer.push(buffer);
+}
+
+void AudioVisualizer::AnalysisThread::run()
+{
+    const int intervalMs = 1000 / maxAnalysisRateHz;
+    
+    // Smoothed meter state and fading tails shouldn't slow this thread down with denormals
+    DenormalProtection::enableForCurrentThread();
+    
+    while (! threadShouldExit())
+    {
+        auto start = juce::Time::getMillisecondCounter();
+        owner.runAnalysis();
+        auto elapsed = (int) (juce::Time::getMillisecondCounter() - start);
+        
+        wait(juce::jmax(1, intervalMs - elapsed));
+    }
+}
+
+void AudioVisualizer::runAnalysis()
+{
+    if (captureBuffer.getTotalWritten() == lastAnalysedPosition)
+        return;
+    
+    lastAnalysedPosition = captureBuffer.getTotalWritten();
+    
+    const auto numChannels = numCapturedChannels.load(std::memory_order_relaxed);
+    auto& frame = frames.getWriteBuffer();
+    frame.numChannels = numChannels;
+    
+    // Correlation meters run continuously, whatever is on screen
+    updateCorrelations(numChannels, frame.correlations.data());
+    
+    // The waveform is drawn from the pyramid and the EQ curve needs no audio
+    switch (visualizationType.load())
     {
-        audioData[writePosition] = channelData[i];
-        writePosition = (writePosition + 1) % bufferSize;
+        case VisualizationType::Spectrum:
+            captureBuffer.readLatest(0, fftData.data(), fftSize);
+            calculateFFT(fftData, frame.magnitudes.data());
+            break;
+        case VisualizationType::MidSideSpectrum:
+            analyseMidSide(numChannels);
+            break;
+        case VisualizationType::Goniometer:
+            captureGoniometer(numChannels);
+            break;
+        case VisualizationType::Waveform:
+        case VisualizationType::EQResponse:
+            break;
     }
     
-    if (visualizationType == VisualizationType::Spectrum)
-        calculateFFT();
+    frame.maxLevel = maxLevel.load(std::memory_order_relaxed);
+    frames.publish();
 }
 
-void AudioVisualizer::drawWaveform(juce::Graphics& g)
+void AudioVisualizer::updateCorrelations(int numChannels, float* correlationsOut)
 {
-    auto bounds = getLocalBounds().toFloat();
-    float centerY = bounds.getCentreY();
-    float width = bounds.getWidth();
+    const int numPairs = numChannels / 2;
+    const auto rate = sampleRate.load(std::memory_order_relaxed);
+    const int maxSamples = (int) channelScratch[0].size() * (int) SIMDFloat::SIMDNumElements;
     
-    g.setColour(juce::Colours::white);
+    // One pass over the new samples: three dot products per pair
+    while (auto numRead = captureBuffer.readSince(0, correlationReadPosition,
+                                                  reinterpret_cast<float*>(channelScratch[0].data()), maxSamples))
+    {
+        for (int ch = 1; ch < numPairs * 2; ++ch)
+        {
+            auto channelPosition = correlationReadPosition - (juce::uint64) numRead;
+            captureBuffer.readSince(ch, channelPosition, reinterpret_cast<float*>(channelScratch[(size_t) ch].data()), numRead);
+        }
+        
+        // Exponential forgetting, so the meters follow the music
+        const auto decay = std::exp(-numRead / (correlationTimeSeconds * rate));
+        
+        for (int pair = 0; pair < numPairs; ++pair)
+        {
+            float leftSquares, rightSquares, crossProduct;
+            calculateDotProducts(reinterpret_cast<const float*>(channelScratch[(size_t) pair * 2].data()),
+                                 reinterpret_cast<const float*>(channelScratch[(size_t) pair * 2 + 1].data()),
+                                 numRead, leftSquares, rightSquares, crossProduct);
+            
+            auto& sums = pairSums[(size_t) pair];
+            sums.leftSquares = sums.leftSquares * decay + leftSquares;
+            sums.rightSquares = sums.rightSquares * decay + rightSquares;
+            sums.crossProduct = sums.crossProduct * decay + crossProduct;
+        }
+    }
+    
+    for (int pair = 0; pair < maxChannelPairs; ++pair)
+    {
+        const auto& sums = pairSums[(size_t) pair];
+        const auto power = std::sqrt(sums.leftSquares * sums.rightSquares);
+        const auto correlation = pair < numPairs && power > 1.0e-12 ? (float) (sums.crossProduct / power) : 0.0f;
+        
+        correlationsOut[pair] = correlation;
+        correlations[(size_t) pair].store(correlation, std::memory_order_relaxed);
+    }
+}
+
+void AudioVisualizer::calculateDotProducts(const float* left, const float* right, int numSamples,
+                                           float& leftSquares, float& rightSquares, float& crossProduct)
+{
+    // Both pointers are SIMD-aligned - the scratch blocks are stored as registers
+    constexpr auto lanes = (int) SIMDFloat::SIMDNumElements;
+    const int numVectors = numSamples / lanes;
+    
+    auto sumLeft = SIMDFloat::expand(0.0f);
+    auto sumRight = SIMDFloat::expand(0.0f);
+    auto sumCross = SIMDFloat::expand(0.0f);
+    
+    for (int i = 0; i < numVectors; ++i)
+    {
+        auto l = SIMDFloat::fromRawArray(left + i * lanes);
+        auto r = SIMDFloat::fromRawArray(right + i * lanes);
+        
+        sumLeft += l * l;
+        sumRight += r * r;
+        sumCross += l * r;
+    }
+    
+    leftSquares = sumLeft.sum();
+    rightSquares = sumRight.sum();
+    crossProduct = sumCross.sum();
+    
+    for (int i = numVectors * lanes; i < numSamples; ++i)
+    {
+        leftSquares += left[i] * left[i];
+        rightSquares += right[i] * right[i];
+        crossProduct += left[i] * right[i];
+    }
+}
+
+void AudioVisualizer::analyseMidSide(int numChannels)
+{
+    auto& frame = frames.getWriteBuffer();
     
-    juce::Path waveformPath;
-    waveformPath.startNewSubPath(0, centerY);
+    captureBuffer.readLatest(0, fftData.data(), fftSize);
     
-    for (int i = 0; i < bufferSize; ++i)
+    if (numChannels < 2)
     {
-        float x = (float)i / bufferSize * width;
-        float y = centerY + audioData[(writePosition + i) % bufferSize] * bounds.getHeight() * 0.5f;
-        waveformPath.lineTo(x, y);
+        // Mono: everything is mid
+        std::fill(sideFftData.begin(), sideFftData.end(), 0.0f);
+    }
+    else
+    {
+        captureBuffer.readLatest(1, sideFftData.data(), fftSize);
+        
+        for (int i = 0; i < fftSize; ++i)
+        {
+            auto left = fftData[(size_t) i];
+            auto right = sideFftData[(size_t) i];
+            fftData[(size_t) i] = 0.5f * (left + right);
+            sideFftData[(size_t) i] = 0.5f * (left - right);
+        }
     }
     
-    g.strokePath(waveformPath, juce::PathStrokeType(2.0f));
+    calculateFFT(fftData, frame.magnitudes.data());
+    calculateFFT(sideFftData, frame.sideMagnitudes.data());
+}
+
+void AudioVisualizer::captureGoniometer(int numChannels)
+{
+    auto& frame = frames.getWriteBuffer();
+    auto* left = frame.goniometerMid.data();
+    auto* right = frame.goniometerSide.data();
+    
+    captureBuffer.readLatest(0, left, goniometerSize);
+    
+    if (numChannels < 2)
+        std::copy(left, left + goniometerSize, right);
+    else
+        captureBuffer.readLatest(1, right, goniometerSize);
+    
+    // Rotate L/R by 45 degrees in place: mid up the vertical axis, side across
+    const float scale = juce::MathConstants<float>::sqrt2 * 0.5f;
+    
+    for (int i = 0; i < goniometerSize; ++i)
+    {
+        auto l = left[i], r = right[i];
+        left[i] = (l + r) * scale;
+        right[i] = (r - l) * scale;
+    }
+}
+
+void AudioVisualizer::drawWaveform(juce::Graphics& g)
+{
+    auto bounds = getLocalBounds();
+    float centerY = (float) bounds.getCentreY();
+    float halfHeight = bounds.getHeight() * 0.5f;
+    
+    // One min/max span per pixel column, whatever the time span
+    columnSpans.resize((size_t) bounds.getWidth());
+    auto firstColumn = waveformPyramid.getColumnSpans(waveformTimeSpan, columnSpans.data(), (int) columnSpans.size());
+    
+    g.setColour(juce::Colours::white);
+    
+    for (int x = firstColumn; x < (int) columnSpans.size(); ++x)
+    {
+        const auto& span = columnSpans[(size_t) x];
+        float top = centerY + span.getStart() * halfHeight;
+        float bottom = centerY + span.getEnd() * halfHeight;
+        
+        // Keep flat sections visible at the old 2px line weight
+        g.fillRect((float) x, top - 1.0f, 1.0f, juce::jmax(2.0f, bottom - top + 2.0f));
+    }
 }
 
 void AudioVisualizer::drawSpectrum(juce::Graphics& g)
@@ -82,6 +280,7 @@ void AudioVisualizer::drawSpectrum(juce::Graphics& g)
     auto bounds = getLocalBounds().toFloat();
     float width = bounds.getWidth();
     float height = bounds.getHeight();
+    const auto& frame = frames.getReadBuffer();
     
     // Create gradient for spectrum
     juce::ColourGradient gradient;
@@ -90,8 +289,18 @@ void AudioVisualizer::drawSpectrum(juce::Graphics& g)
     gradient.addColour(0.6, gradientColours[2]);
     gradient.addColour(1.0, gradientColours[3]);
     
-    juce::Path spectrumPath;
-    spectrumPath.startNewSubPath(0, height);
+    auto spectrumPath = createSpectrumPath(frame.magnitudes.data(), frame.maxLevel, width, height);
+    
+    g.setGradientFill(gradient);
+    PathStatistics::recordPath(spectrumPath);
+    g.fillPath(spectrumPath);
+}
+
+juce::Path AudioVisualizer::createSpectrumPath(const float* magnitudes, float normaliser, float width, float height)
+{
+    // Towards the top of the log axis hundreds of bins land on each pixel
+    // column - only the points that change what is drawn are kept
+    spectrumCurve.clear();
     
     for (int i = 0; i < fftSize / 2; ++i)
     {
@@ -100,38 +309,112 @@ void AudioVisualizer::drawSpectrum(juce::Graphics& g)
         
         if (x >= 0 && x <= width)
         {
-            float level = juce::jlimit(0.0f, 1.0f, fftData[i] / maxLevel);
+            float level = normaliser > 0.0f ? juce::jlimit(0.0f, 1.0f, magnitudes[i] / normaliser) : 0.0f;
             float y = height - level * height;
-            spectrumPath.lineTo(x, y);
+            spectrumCurve.addPoint(x, y);
         }
     }
     
+    juce::Path spectrumPath;
+    spectrumPath.startNewSubPath(0, height);
+    spectrumCurve.appendTo(spectrumPath, false);
     spectrumPath.lineTo(width, height);
     spectrumPath.closeSubPath();
     
-    g.setGradientFill(gradient);
-    g.fillPath(spectrumPath);
+    return spectrumPath;
 }
 
-void AudioVisualizer::calculateFFT()
+void AudioVisualizer::drawMidSideSpectrum(juce::Graphics& g)
 {
-    for (int i = 0; i < fftSize; ++i)
+    auto bounds = getLocalBounds().toFloat();
+    const auto& frame = frames.getReadBuffer();
+    
+    // Shared scale, so side is shown relative to mid
+    float peak = 0.0f;
+    
+    for (size_t i = 0; i < frame.magnitudes.size(); ++i)
+        peak = juce::jmax(peak, frame.magnitudes[i], frame.sideMagnitudes[i]);
+    
+    auto midPath = createSpectrumPath(frame.magnitudes.data(), peak, bounds.getWidth(), bounds.getHeight());
+    auto sidePath = createSpectrumPath(frame.sideMagnitudes.data(), peak, bounds.getWidth(), bounds.getHeight());
+    
+    g.setColour(gradientColours[0].withAlpha(0.6f));
+    PathStatistics::recordPath(midPath);
+    g.fillPath(midPath);
+    
+    g.setColour(gradientColours[3].withAlpha(0.8f));
+    PathStatistics::recordPath(sidePath);
+    g.strokePath(sidePath, juce::PathStrokeType(1.5f));
+    
+    g.setColour(juce::Colours::white);
+    g.setFont(12.0f);
+    g.drawText("Mid", bounds.reduced(6.0f).removeFromTop(14.0f), juce::Justification::topLeft);
+    g.setColour(gradientColours[3]);
+    g.drawText("Side", bounds.reduced(6.0f).removeFromTop(14.0f).withTrimmedLeft(30.0f), juce::Justification::topLeft);
+}
+
+void AudioVisualizer::drawGoniometer(juce::Graphics& g)
+{
+    const auto& frame = frames.getReadBuffer();
+    auto bounds = getLocalBounds().toFloat();
+    
+    // One correlation meter per channel pair along the bottom
+    const int numPairs = juce::jmax(1, frame.numChannels / 2);
+    auto meterArea = bounds.removeFromBottom(12.0f * numPairs + 4.0f).reduced(6.0f, 2.0f);
+    
+    for (int pair = 0; pair < numPairs; ++pair)
     {
-        fftData[i] = audioData[(writePosition + i) % bufferSize] * fftWindow[i];
-        fftData[i + fftSize] = 0.0f; // Clear imaginary part
+        auto meter = meterArea.removeFromTop(12.0f).reduced(0.0f, 2.0f);
+        auto correlation = frame.numChannels >= 2 ? frame.correlations[(size_t) pair] : 1.0f;
+        auto centreX = meter.getCentreX();
+        auto valueX = centreX + correlation * meter.getWidth() * 0.5f;
+        
+        g.setColour(juce::Colours::darkgrey);
+        g.fillRect(meter);
+        
+        g.setColour(correlation < 0.0f ? juce::Colours::red : juce::Colours::limegreen);
+        g.fillRect(juce::Rectangle<float>::leftTopRightBottom(juce::jmin(centreX, valueX), meter.getY(),
+                                                              juce::jmax(centreX, valueX), meter.getBottom()));
+        
+        g.setColour(juce::Colours::white.withAlpha(0.6f));
+        g.drawVerticalLine((int) centreX, meter.getY(), meter.getBottom());
     }
     
-    fft.performRealOnlyForwardTransform(fftData.data(), true);
+    // Vectorscope of the first pair in the remaining square
+    auto scope = bounds.withSizeKeepingCentre(juce::jmin(bounds.getWidth(), bounds.getHeight()),
+                                              juce::jmin(bounds.getWidth(), bounds.getHeight())).reduced(6.0f);
+    auto centre = scope.getCentre();
+    auto radius = scope.getWidth() * 0.5f;
     
-    // Calculate magnitudes
-    for (int i = 0; i < fftSize / 2; ++i)
+    g.setColour(juce::Colours::darkgrey);
+    g.drawLine(scope.getX(), scope.getBottom(), scope.getRight(), scope.getY());   // Right channel
+    g.drawLine(scope.getX(), scope.getY(), scope.getRight(), scope.getBottom());   // Left channel
+    g.drawVerticalLine((int) centre.x, scope.getY(), scope.getBottom());
+    
+    g.setColour(juce::Colours::limegreen.withAlpha(0.5f));
+    
+    for (int i = 0; i < goniometerSize; ++i)
     {
-        float real = fftData[i];
-        float imag = fftData[i + fftSize];
-        fftData[i] = std::sqrt(real * real + imag * imag);
+        auto x = centre.x + juce::jlimit(-1.0f, 1.0f, frame.goniometerSide[(size_t) i]) * radius;
+        auto y = centre.y - juce::jlimit(-1.0f, 1.0f, frame.goniometerMid[(size_t) i]) * radius;
+        g.fillRect(x, y, 1.5f, 1.5f);
     }
 }
 
+void AudioVisualizer::calculateFFT(std::vector<float>& data, float* magnitudes)
+{
+    // Runs on the analysis thread with the latest samples already unrolled into data
+    for (int i = 0; i < fftSize; ++i)
+    {
+        data[(size_t) i] *= fftWindow[(size_t) i];
+        data[(size_t) (i + fftSize)] = 0.0f; // Clear imaginary part
+    }
+    
+    fft.performFrequencyOnlyForwardTransform(data.data(), true);
+    
+    std::copy(data.begin(), data.begin() + fftSize / 2, magnitudes);
+}
+
 void AudioVisualizer::drawEQResponse(juce::Graphics& g)
 {
     auto bounds = getLocalBounds().toFloat();
@@ -139,55 +422,84 @@ void AudioVisualizer::drawEQResponse(juce::Graphics& g)
     float height = bounds.getHeight();
     float centerY = height * 0.5f;
     
-    // Frequency grid
-    g.setColour(juce::Colours::darkgrey);
-    float frequencies[] = { 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000 };
-    for (float freq : frequencies)
+    // Frequency grid, labels and 0dB line only change with the size, so they're
+    // rendered once into the cached layer
+    eqGridLayer.draw(g, getLocalBounds(), [] (juce::Graphics& layer, juce::Rectangle<float> area)
     {
-        float x = std::log10(freq / minFreq) * width / std::log10(maxFreq / minFreq);
-        g.drawVerticalLine(int(x), 0.0f, height);
+        const float gridWidth = area.getWidth();
+        const float gridHeight = area.getHeight();
+        const float logRange = std::log10(maxFreq / minFreq);
         
-        // Frequency labels
-        g.setFont(12.0f);
-        juce::String label = (freq >= 1000) ? juce::String(freq / 1000) + "k" : juce::String(freq);
-        g.drawText(label, int(x) - 20, int(height) - 20, 40, 20, juce::Justification::centred);
-    }
-    
-    // 0dB line
-    g.setColour(juce::Colours::darkgrey);
-    g.drawHorizontalLine(int(centerY), 0.0f, width);
-    
-    // EQ response curve
-    if (getFrequencyResponse)
-    {
-        g.setColour(juce::Colours::orange);
-        juce::Path responsePath;
-        bool pathStarted = false;
+        layer.setColour(juce::Colours::darkgrey);
+        layer.setFont(12.0f);
         
-        for (float x = 0; x < width; x += 1.0f)
+        float frequencies[] = { 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000 };
+        for (float freq : frequencies)
         {
-            float freq = minFreq * std::pow(maxFreq / minFreq, x / width);
-            float response = getFrequencyResponse(freq);
-            float y = centerY - response * height * 0.25f; // Scale by 0.25 to show ±12dB range
+            float x = std::log10(freq / minFreq) * gridWidth / logRange;
+            layer.drawVerticalLine(int(x), 0.0f, gridHeight);
             
-            if (!pathStarted)
-            {
-                responsePath.startNewSubPath(x, y);
-                pathStarted = true;
-            }
-            else
-            {
-                responsePath.lineTo(x, y);
-            }
+            // Frequency labels
+            juce::String label = (freq >= 1000) ? juce::String(freq / 1000) + "k" : juce::String(freq);
+            layer.drawText(label, int(x) - 20, int(gridHeight) - 20, 40, 20, juce::Justification::centred);
         }
         
-        g.strokePath(responsePath, juce::PathStrokeType(2.0f));
+        // 0dB line
+        layer.drawHorizontalLine(int(gridHeight * 0.5f), 0.0f, gridWidth);
+    });
+    
+    // EQ response curve - the evaluator only recomputes when the filters or the
+    // width changed, and the path is only rebuilt when it did
+    if (eqSampleRate <= 0.0)
+        return;
+    
+    eqResponse.setFrequencyRange((int) width, eqSampleRate, minFreq, maxFreq);
+    
+    if (eqResponse.update() || eqResponsePathHeight != (int) height)
+    {
+        eqResponsePath.clear();
+        eqResponsePathHeight = (int) height;
+        
+        const auto* decibels = eqResponse.getDecibels();
+        const int numPoints = eqResponse.getNumPoints();
+        const float xScale = width / (float) (numPoints - 1);
+        const float yScale = height * 0.5f / eqDisplayRangeDb;
+        
+        eqResponsePath.preallocateSpace(numPoints * 3);
+        eqResponsePath.startNewSubPath(0.0f, centerY - decibels[0] * yScale);
+        
+        for (int i = 1; i < numPoints; ++i)
+            eqResponsePath.lineTo((float) i * xScale, centerY - decibels[i] * yScale);
     }
+    
+    g.setColour(juce::Colours::orange);
+    PathStatistics::recordPath(eqResponsePath);
+    g.strokePath(eqResponsePath, juce::PathStrokeType(2.0f));
 }
 
-void AudioVisualizer::timerCallback()
+void AudioVisualizer::updateFrame()
 {
-    repaint();
+    // Fold newly captured samples into the waveform pyramid
+    bool newWaveformData = false;
+    
+    while (auto numRead = captureBuffer.readSince(0, waveformReadPosition, waveformScratch.data(), (int) waveformScratch.size()))
+    {
+        waveformPyramid.addSamples(waveformScratch.data(), numRead);
+        newWaveformData = true;
+    }
+    
+    // Only repaint when something new has arrived; the EQ curve doesn't depend
+    // on audio and is repainted when its type or filters change
+    bool newFrame = frames.acquireLatest();
+    
+    switch (visualizationType.load())
+    {
+        case VisualizationType::Waveform:   if (newWaveformData) frameClient.markDirty(); break;
+        case VisualizationType::Spectrum:
+        case VisualizationType::MidSideSpectrum:
+        case VisualizationType::Goniometer: if (newFrame) frameClient.markDirty(); break;
+        case VisualizationType::EQResponse: break;
+    }
 }
 
 void AudioVisualizer::resized()
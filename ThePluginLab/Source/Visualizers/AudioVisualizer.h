@@ -1,9 +1,17 @@
 #pragma once
 #include <JuceHeader.h>
 #include <array>
+#include <atomic>
+#include "../Common/TripleBuffer.h"
+#include "CaptureRingBuffer.h"
+#include "WaveformPyramid.h"
+#include "CachedBackgroundLayer.h"
+#include "FrequencyResponseEvaluator.h"
+#include "PathStatistics.h"
+#include "CurveBuilder.h"
+#include "../GUI/FrameScheduler.h"
 
-class AudioVisualizer : public juce::Component,
-                       public juce::Timer
+class AudioVisualizer : public juce::Component
 {
 public:
     AudioVisualizer();
@@ -12,43 +20,148 @@ public:
     void paint(juce::Graphics& g) override;
     void resized() override;
     
-    // To update the visualization
+    // To update the visualization. Safe to call from the audio thread - it only
+    // copies samples (up to maxChannels) into the capture ring; analysis runs on
+    // a background thread.
     void pushBuffer(const juce::AudioBuffer<float>& buffer);
     
-    // Timer callback for animation
-    void timerCallback() override;
-    
     enum class VisualizationType
     {
         Waveform,
         Spectrum,
-        EQResponse
+        EQResponse,
+        MidSideSpectrum,   // Mid and side spectra of the first channel pair
+        Goniometer         // Vectorscope of the first pair, with correlation meters for every pair
     };
     
-    void setVisualizationType(VisualizationType type) { visualizationType = type; }
+    static constexpr int maxChannels = 8;   // Up to 7.1
+    static constexpr int maxChannelPairs = maxChannels / 2;
+    
+    // Used for the correlation meters' time constant
+    void setSampleRate(double newSampleRate) { sampleRate.store(newSampleRate); }
+    
+    // Smoothed correlation of channels 2n and 2n + 1, from -1 (out of phase) to +1 (mono).
+    // Safe to call from any thread.
+    float getCorrelation(int pairIndex) const
+    {
+        return juce::isPositiveAndBelow(pairIndex, maxChannelPairs) ? correlations[(size_t) pairIndex].load() : 0.0f;
+    }
+    
+    void setVisualizationType(VisualizationType type) { visualizationType.store(type); frameClient.markDirty(); }
+    
+    // Filters whose combined response is drawn in EQResponse mode. The curve is
+    // only re-evaluated when these (or the component's size) change.
+    void setEQFilters(const std::vector<FrequencyResponseEvaluator::Biquad>& filters, double sampleRate)
+    {
+        eqResponse.setFilters(filters);
+        eqSampleRate = sampleRate;
+        frameClient.markDirty();
+    }
     
-    void setFrequencyResponseCallback(std::function<float(float)> callback) { getFrequencyResponse = callback; }
+    // Number of samples of history shown in Waveform mode - any length up to
+    // several minutes draws at the same cost
+    void setWaveformTimeSpan(int numSamples) { waveformTimeSpan = juce::jmax(1, numSamples); frameClient.markDirty(); }
     
 private:
+    friend class VisualizerRenderHarness;
+    
+    // Called by the frame scheduler once per display frame
+    void updateFrame();
+    
     void drawWaveform(juce::Graphics& g);
     void drawSpectrum(juce::Graphics& g);
-    void calculateFFT();
     void drawEQResponse(juce::Graphics& g);
+    void drawMidSideSpectrum(juce::Graphics& g);
+    void drawGoniometer(juce::Graphics& g);
+    juce::Path createSpectrumPath(const float* magnitudes, float normaliser, float width, float height);
+    
+    // Analysis thread - drains the FIFO and publishes frames
+    void runAnalysis();
+    void calculateFFT(std::vector<float>& data, float* magnitudes);
+    void updateCorrelations(int numChannels, float* correlationsOut);
+    void analyseMidSide(int numChannels);
+    void captureGoniometer(int numChannels);
+    
+    // Sums of squares and cross products of a pair over numSamples, with SIMD registers
+    static void calculateDotProducts(const float* left, const float* right, int numSamples,
+                                     float& leftSquares, float& rightSquares, float& crossProduct);
+    
+    class AnalysisThread : public juce::Thread
+    {
+    public:
+        explicit AnalysisThread(AudioVisualizer& ownerToUse)
+            : juce::Thread("AudioVisualizer analysis"), owner(ownerToUse) {}
+        
+        void run() override;
+        
+    private:
+        AudioVisualizer& owner;
+    };
     
-    VisualizationType visualizationType = VisualizationType::Waveform;
+    std::atomic<VisualizationType> visualizationType { VisualizationType::Waveform };
     
     static constexpr int bufferSize = 1024;
-    std::array<float, bufferSize> audioData{};
-    int writePosition = 0;
     
     static constexpr int fftOrder = 11;  // 2048 points
     static constexpr int fftSize = 1 << fftOrder;
     
+    // Maximum analysis rate - the FFT never runs more often than this
+    static constexpr int maxAnalysisRateHz = 30;
+    
+    static constexpr int goniometerSize = 1024;
+    
+    // Audio thread -> analysis thread
+    CaptureRingBuffer captureBuffer { maxChannels, fftSize * 2 };
+    std::atomic<float> maxLevel { 0.0f };
+    std::atomic<int> numCapturedChannels { 1 };
+    std::atomic<double> sampleRate { 44100.0 };
+    
+    // Owned by the analysis thread
+    juce::uint64 lastAnalysedPosition = 0;
     juce::dsp::FFT fft;
     std::vector<float> fftData;
+    std::vector<float> sideFftData;
     std::vector<float> fftWindow;
     
-    float maxLevel = 0.0f;
+    // Stereo-field state, also owned by the analysis thread. The scratch blocks are
+    // stored as SIMD registers so every channel starts on an aligned boundary.
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+    std::array<std::vector<SIMDFloat>, maxChannels> channelScratch;
+    juce::uint64 correlationReadPosition = 0;
+    
+    struct PairSums
+    {
+        double leftSquares = 0.0, rightSquares = 0.0, crossProduct = 0.0;
+    };
+    
+    std::array<PairSums, maxChannelPairs> pairSums;
+    std::array<std::atomic<float>, maxChannelPairs> correlations {};
+    static constexpr double correlationTimeSeconds = 0.3;
+    
+    // Analysis thread -> message thread
+    struct Frame
+    {
+        std::array<float, fftSize / 2> magnitudes {};       // Mid in MidSideSpectrum mode
+        std::array<float, fftSize / 2> sideMagnitudes {};
+        std::array<float, goniometerSize> goniometerMid {}, goniometerSide {};
+        std::array<float, maxChannelPairs> correlations {};
+        int numChannels = 1;
+        float maxLevel = 0.0f;
+    };
+    
+    TripleBuffer<Frame> frames;
+    AnalysisThread analysisThread { *this };
+    
+    // Waveform history - fed from the capture ring on the message thread
+    WaveformPyramid waveformPyramid;
+    juce::uint64 waveformReadPosition = 0;
+    std::vector<float> waveformScratch;
+    std::vector<juce::Range<float>> columnSpans;
+    int waveformTimeSpan = bufferSize;
+    
+    // Collapses the FFT bins that share a pixel column on the log axis
+    CurveBuilder spectrumCurve;
+    
     juce::Colour gradientColours[4] = {
         juce::Colours::blue,
         juce::Colours::green,
@@ -56,11 +169,23 @@ private:
         juce::Colours::red
     };
     
-    std::function<float(float)> getFrequencyResponse;
+    // EQ response - evaluated in batch, one point per pixel
+    FrequencyResponseEvaluator eqResponse;
+    double eqSampleRate = 0.0;
+    juce::Path eqResponsePath;
+    int eqResponsePathHeight = 0;
+    
+    // Static EQ grid and labels, re-rendered only on size or scale changes
+    CachedBackgroundLayer eqGridLayer;
+    
+    FrameScheduler::Client frameClient { this, [this] { updateFrame(); } };
     
     // Frequency range for EQ visualization
     static constexpr float minFreq = 20.0f;
     static constexpr float maxFreq = 20000.0f;
     
+    // The EQ curve spans +/- this many dB
+    static constexpr float eqDisplayRangeDb = 12.0f;
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioVisualizer)
 }; 
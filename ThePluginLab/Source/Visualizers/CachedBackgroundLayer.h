@@ -0,0 +1,61 @@
+#pragma once
+#include <JuceHeader.h>
+#include <functional>
+
+/**
+ * Image cache for the static parts of a visualizer (grids, scales, labels).
+ *
+ * The layer is rendered once at the display's physical resolution and then
+ * composited 1:1 on every paint. It is re-rendered only when the size or the
+ * pixel scale factor changes, or when the owner calls invalidate() because
+ * something it draws (colours, ranges, labels) has changed.
+ */
+class CachedBackgroundLayer
+{
+public:
+    using RenderFunction = std::function<void(juce::Graphics&, juce::Rectangle<float>)>;
+
+    CachedBackgroundLayer() = default;
+
+    // Forces a re-render on the next draw
+    void invalidate() noexcept { cachedImage = {}; }
+
+    /**
+     * Draws the layer at area, re-rendering it first if needed. The render function
+     * draws in the same logical coordinates as area.
+     */
+    void draw(juce::Graphics& g, juce::Rectangle<int> area, const RenderFunction& render)
+    {
+        if (area.isEmpty())
+            return;
+
+        const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+        if (! cachedImage.isValid() || area != cachedArea || scale != cachedScale)
+        {
+            cachedArea = area;
+            cachedScale = scale;
+
+            cachedImage = juce::Image(juce::Image::ARGB,
+                                      juce::jmax(1, juce::roundToInt(area.getWidth() * scale)),
+                                      juce::jmax(1, juce::roundToInt(area.getHeight() * scale)),
+                                      true);
+
+            juce::Graphics imageGraphics(cachedImage);
+            imageGraphics.addTransform(juce::AffineTransform::scale(scale));
+            imageGraphics.setOrigin(-area.getPosition());
+            render(imageGraphics, area.toFloat());
+        }
+
+        g.drawImageTransformed(cachedImage,
+                               juce::AffineTransform::scale(1.0f / scale)
+                                   .translated((float) area.getX(), (float) area.getY()));
+    }
+
+private:
+    juce::Image cachedImage;
+    juce::Rectangle<int> cachedArea;
+    float cachedScale = 1.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CachedBackgroundLayer)
+};
@@ -0,0 +1,164 @@
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <cstring>
+
+/**
+ * Multichannel sample capture ring shared by the visualizers.
+ *
+ * One producer (normally the audio thread) pushes blocks; any number of
+ * readers take snapshots of the most recent samples or everything written
+ * since their last read. The capacity is rounded up to a power of two so
+ * positions wrap with a mask, and every push or read is at most two
+ * memcpy spans per channel.
+ *
+ * Positions are absolute 64-bit sample counts. A reader that falls more than
+ * one capacity behind the producer skips ahead rather than reading
+ * overwritten data.
+ */
+class CaptureRingBuffer
+{
+public:
+    CaptureRingBuffer(int numChannelsToUse, int minimumCapacity)
+        : capacity(juce::nextPowerOfTwo(juce::jmax(2, minimumCapacity))),
+          mask((juce::uint64) capacity - 1),
+          storage(juce::jmax(1, numChannelsToUse), capacity)
+    {
+        storage.clear();
+    }
+
+    int getCapacity() const noexcept { return capacity; }
+    int getNumChannels() const noexcept { return storage.getNumChannels(); }
+
+    // Absolute number of samples pushed so far - doubles as a change counter for readers
+    juce::uint64 getTotalWritten() const noexcept { return totalWritten.load(std::memory_order_acquire); }
+
+    //==============================================================================
+    // Producer side
+
+    void push(const float* const* channelData, int numSourceChannels, int numSamples) noexcept
+    {
+        if (numSamples <= 0 || numSourceChannels <= 0)
+            return;
+
+        auto total = totalWritten.load(std::memory_order_relaxed);
+
+        // Anything older than one capacity would be overwritten straight away
+        auto skip = juce::jmax(0, numSamples - capacity);
+        auto count = numSamples - skip;
+        auto start = (total + (juce::uint64) skip) & mask;
+
+        for (int ch = 0; ch < getNumChannels(); ++ch)
+        {
+            // Mono sources are duplicated to every capture channel
+            auto* source = channelData[juce::jmin(ch, numSourceChannels - 1)] + skip;
+            copyIn(ch, source, (int) start, count);
+        }
+
+        totalWritten.store(total + (juce::uint64) numSamples, std::memory_order_release);
+    }
+
+    void push(const juce::AudioBuffer<float>& buffer) noexcept
+    {
+        if (buffer.getNumChannels() > 0)
+            push(buffer.getArrayOfReadPointers(), buffer.getNumChannels(), buffer.getNumSamples());
+    }
+
+    void pushSample(float sample) noexcept
+    {
+        const float* channels[] = { &sample };
+        push(channels, 1, 1);
+    }
+
+    //==============================================================================
+    // Reader side
+
+    /**
+     * Copies the most recent numSamples of a channel, oldest first. Returns the
+     * write position the snapshot ends at. Samples not yet written read as zero.
+     */
+    juce::uint64 readLatest(int channel, float* destination, int numSamples) const noexcept
+    {
+        numSamples = juce::jmin(numSamples, capacity);
+
+        for (int attempt = 0;; ++attempt)
+        {
+            auto end = getTotalWritten();
+            auto available = (int) juce::jmin((juce::uint64) numSamples, end);
+            auto padding = numSamples - available;
+
+            if (padding > 0)
+                juce::FloatVectorOperations::clear(destination, padding);
+
+            copyOut(channel, destination + padding, (int) ((end - (juce::uint64) available) & mask), available);
+
+            // If the producer lapped us mid-copy, take a fresh snapshot
+            if (getTotalWritten() - end + (juce::uint64) numSamples <= (juce::uint64) capacity || attempt == 2)
+                return end;
+        }
+    }
+
+    /**
+     * Copies up to maxSamples written since readPosition and advances it. Returns
+     * the number of samples copied. Readers that fell too far behind skip ahead.
+     */
+    int readSince(int channel, juce::uint64& readPosition, float* destination, int maxSamples) const noexcept
+    {
+        auto end = getTotalWritten();
+
+        if (readPosition > end)
+            readPosition = end;   // The ring was reset
+        else if (end - readPosition > (juce::uint64) capacity)
+            readPosition = end - (juce::uint64) capacity;
+
+        auto count = (int) juce::jmin((juce::uint64) maxSamples, end - readPosition);
+        copyOut(channel, destination, (int) (readPosition & mask), count);
+
+        // Drop anything the producer overwrote while we were copying
+        auto overwrittenUpTo = getTotalWritten();
+
+        if (overwrittenUpTo > (juce::uint64) capacity && overwrittenUpTo - (juce::uint64) capacity > readPosition)
+        {
+            auto lost = (int) juce::jmin((juce::uint64) count, overwrittenUpTo - (juce::uint64) capacity - readPosition);
+            std::memmove(destination, destination + lost, sizeof(float) * (size_t) (count - lost));
+            readPosition += (juce::uint64) lost;
+            count -= lost;
+        }
+
+        readPosition += (juce::uint64) count;
+        return count;
+    }
+
+    // Clears the contents. Only call while the producer is stopped.
+    void reset() noexcept
+    {
+        storage.clear();
+        totalWritten.store(0, std::memory_order_release);
+    }
+
+private:
+    void copyIn(int channel, const float* source, int start, int count) noexcept
+    {
+        auto* dest = storage.getWritePointer(channel);
+        auto firstSpan = juce::jmin(count, capacity - start);
+
+        std::memcpy(dest + start, source, sizeof(float) * (size_t) firstSpan);
+        std::memcpy(dest, source + firstSpan, sizeof(float) * (size_t) (count - firstSpan));
+    }
+
+    void copyOut(int channel, float* destination, int start, int count) const noexcept
+    {
+        auto* source = storage.getReadPointer(channel);
+        auto firstSpan = juce::jmin(count, capacity - start);
+
+        std::memcpy(destination, source + start, sizeof(float) * (size_t) firstSpan);
+        std::memcpy(destination + firstSpan, source, sizeof(float) * (size_t) (count - firstSpan));
+    }
+
+    const int capacity;
+    const juce::uint64 mask;
+    juce::AudioBuffer<float> storage;
+    std::atomic<juce::uint64> totalWritten { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CaptureRingBuffer)
+};
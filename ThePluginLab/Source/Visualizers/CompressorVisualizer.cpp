@@ -11,6 +11,96 @@ CompressorVisualizer::~CompressorVisualizer()
 }
 
 void CompressorVisualizer::paint(juce::Graphics& g)
+{
+    FrameScheduler::Client::ScopedPaintTimer paintTimer(frameClient);
+    
+    // Everything that only changes with the settings or size comes from the cache
+    staticLayer.draw(g, getLocalBounds(), [this] (juce::Graphics& layer, juce::Rectangle<float>)
+    {
+        drawTransferCurve(layer);
+    });
+    
+    drawHistory(g);
+    
+    // Draw info text
+    auto textArea = readoutArea;
+    g.setColour(juce::Colours::white);
+    g.setFont(12.0f);
+    g.drawText("Threshold: " + juce::String(threshold, 1) + " dB",
+              textArea.removeFromTop(15), juce::Justification::topLeft, false);
+    g.drawText("Ratio: " + juce::String(ratio, 1) + ":1",
+              textArea.removeFromTop(15), juce::Justification::topLeft, false);
+    g.drawText("GR: " + juce::String(currentGainReduction, 1) + " dB",
+              textArea.removeFromTop(15), juce::Justification::topLeft, false);
+}
+
+void CompressorVisualizer::resized()
+{
+    auto bounds = getLocalBounds().reduced(4);
+    
+    historyArea = bounds.removeFromBottom(juce::roundToInt(bounds.getHeight() * 0.4f));
+    curveArea = bounds;
+    readoutArea = curveArea.withSize(juce::jmin(curveArea.getWidth(), 130), juce::jmin(curveArea.getHeight(), 45));
+    
+    // One telemetry column per pixel across the strip
+    history.assign((size_t) juce::jmax(1, historyArea.getWidth()), Telemetry());
+    historyWritePosition = 0;
+    
+    staticLayer.invalidate();
+    frameClient.markDirty();
+}
+
+void CompressorVisualizer::updateSettings(float newThreshold, float newRatio, 
+                                        float newAttack, float newRelease)
+{
+    threshold = newThreshold;
+    ratio = newRatio;
+    attack = newAttack;
+    release = newRelease;
+    
+    staticLayer.invalidate();
+    frameClient.markDirty();
+}
+
+void CompressorVisualizer::updateFrame()
+{
+    if (telemetrySource == nullptr)
+        return;
+    
+    Telemetry columns[64];
+    bool newData = false;
+    
+    while (auto numRead = telemetrySource->readTelemetry(columns, (int) juce::numElementsInArray(columns)))
+    {
+        for (int i = 0; i < numRead; ++i)
+            addToHistory(columns[i]);
+        
+        newData = true;
+    }
+    
+    if (newData)
+        markHistoryDirty();
+}
+
+void CompressorVisualizer::addToHistory(const Telemetry& telemetry)
+{
+    currentGainReduction = telemetry.gainReductionDb;
+    
+    if (history.empty())
+        return;
+    
+    history[historyWritePosition] = telemetry;
+    historyWritePosition = (historyWritePosition + 1) % history.size();
+}
+
+void CompressorVisualizer::markHistoryDirty()
+{
+    // The transfer curve hasn't changed - only the scrolling strip and the readout
+    frameClient.markDirty(historyArea);
+    frameClient.markDirty(readoutArea);
+}
+
+void CompressorVisualizer::drawTransferCurve(juce::Graphics& g)
 {
     // Fill the background
     g.fillAll(juce::Colours::black.withAlpha(0.8f));
@@ -20,14 +110,13 @@ void CompressorVisualizer::paint(juce::Graphics& g)
     g.drawRect(getLocalBounds(), 1);
     
     // Draw a representation of the compressor curve
-    auto bounds = getLocalBounds().reduced(4);
     juce::Path curve;
     
     // Starting point (bottom left)
-    const float width = static_cast<float>(bounds.getWidth());
-    const float height = static_cast<float>(bounds.getHeight());
-    const float startX = static_cast<float>(bounds.getX());
-    const float startY = static_cast<float>(bounds.getBottom());
+    const float width = static_cast<float>(curveArea.getWidth());
+    const float height = static_cast<float>(curveArea.getHeight());
+    const float startX = static_cast<float>(curveArea.getX());
+    const float startY = static_cast<float>(curveArea.getBottom());
     
     // Normalize threshold to curve position (0-1)
     const float thresholdNormalized = juce::jmap(threshold, -60.0f, 0.0f, 0.0f, 1.0f);
@@ -45,51 +134,67 @@ void CompressorVisualizer::paint(juce::Graphics& g)
     
     // Draw the curve
     g.setColour(juce::Colours::white);
+    PathStatistics::recordPath(curve);
     g.strokePath(curve, juce::PathStrokeType(2.0f));
     
     // Draw threshold line
     g.setColour(juce::Colours::yellow.withAlpha(0.5f));
-    g.drawVerticalLine(static_cast<int>(thresholdX), static_cast<float>(bounds.getY()), 
-                   static_cast<float>(bounds.getBottom()));
-    
-    // Draw current gain reduction meter
-    const float reductionHeight = juce::jmap(currentGainReduction, 0.0f, 20.0f, 0.0f, height * 0.5f);
-    const juce::Rectangle<float> reductionMeter(
-        static_cast<float>(bounds.getX()), 
-        static_cast<float>(bounds.getBottom() - reductionHeight),
-        10.0f, reductionHeight);
-    
-    g.setColour(juce::Colours::red.withAlpha(0.7f));
-    g.fillRect(reductionMeter);
+    g.drawVerticalLine(static_cast<int>(thresholdX), static_cast<float>(curveArea.getY()), 
+                   static_cast<float>(curveArea.getBottom()));
     
-    // Draw info text
-    g.setColour(juce::Colours::white);
-    g.setFont(12.0f);
-    g.drawText("Threshold: " + juce::String(threshold, 1) + " dB",
-              bounds.removeFromTop(15), juce::Justification::topLeft, false);
-    g.drawText("Ratio: " + juce::String(ratio, 1) + ":1",
-              bounds.removeFromTop(15), juce::Justification::topLeft, false);
-    g.drawText("GR: " + juce::String(currentGainReduction, 1) + " dB",
-              bounds.removeFromTop(15), juce::Justification::topLeft, false);
+    // History strip outline
+    g.setColour(juce::Colours::white.withAlpha(0.2f));
+    g.drawRect(historyArea, 1);
 }
 
-void CompressorVisualizer::resized()
+void CompressorVisualizer::drawHistory(juce::Graphics& g)
 {
-    // Nothing special needed here
-}
-
-void CompressorVisualizer::updateSettings(float newThreshold, float newRatio, 
-                                        float newAttack, float newRelease)
-{
-    threshold = newThreshold;
-    ratio = newRatio;
-    attack = newAttack;
-    release = newRelease;
-    repaint();
-}
-
-void CompressorVisualizer::updateGainReduction(float gainReductionDb)
-{
-    currentGainReduction = gainReductionDb;
-    repaint();
+    if (history.empty())
+        return;
+    
+    const auto area = historyArea.toFloat();
+    const auto numColumns = history.size();
+    
+    // Levels from -60 to 0 dB, bottom to top
+    auto levelToY = [area] (float levelDb)
+    {
+        return area.getBottom() - juce::jmap(juce::jlimit(-60.0f, 0.0f, levelDb), -60.0f, 0.0f, 0.0f, area.getHeight());
+    };
+    
+    juce::Path inputTrace, outputTrace;
+    inputTrace.preallocateSpace((int) numColumns * 3);
+    outputTrace.preallocateSpace((int) numColumns * 3);
+    
+    // Gain reduction hangs down from the top, 0 - 20 dB over the full strip
+    g.setColour(juce::Colours::red.withAlpha(0.5f));
+    
+    for (size_t i = 0; i < numColumns; ++i)
+    {
+        const auto& entry = history[(historyWritePosition + i) % numColumns];
+        const auto x = area.getX() + (float) i;
+        
+        const auto reduction = juce::jmap(juce::jlimit(0.0f, 20.0f, entry.gainReductionDb), 0.0f, 20.0f, 0.0f, area.getHeight());
+        
+        if (reduction > 0.0f)
+            g.fillRect(x, area.getY(), 1.0f, reduction);
+        
+        if (i == 0)
+        {
+            inputTrace.startNewSubPath(x, levelToY(entry.inputLevelDb));
+            outputTrace.startNewSubPath(x, levelToY(entry.outputLevelDb));
+        }
+        else
+        {
+            inputTrace.lineTo(x, levelToY(entry.inputLevelDb));
+            outputTrace.lineTo(x, levelToY(entry.outputLevelDb));
+        }
+    }
+    
+    g.setColour(juce::Colours::grey);
+    PathStatistics::recordPath(inputTrace);
+    g.strokePath(inputTrace, juce::PathStrokeType(1.0f));
+    
+    g.setColour(juce::Colours::white);
+    PathStatistics::recordPath(outputTrace);
+    g.strokePath(outputTrace, juce::PathStrokeType(1.0f));
 }
@@ -1,8 +1,20 @@
 #pragma once
 #include <JuceHeader.h>
+#include <vector>
+#include "../Audio/Processors/CompressorProcessor.h"
+#include "../GUI/FrameScheduler.h"
+#include "CachedBackgroundLayer.h"
+#include "PathStatistics.h"
 
 /**
  * Visualizer for the compressor node showing compression curve and gain reduction
+ *
+ * The transfer curve is drawn from a cached layer and only re-rendered when the
+ * settings change. Telemetry from the CompressorProcessor, one column per
+ * CompressorProcessor::telemetryColumnSeconds of audio, feeds a scrolling history
+ * of input level, output level and gain reduction, so it scrolls at the same
+ * speed at any block size. Each frame only the history strip and the readout
+ * are repainted.
  */
 class CompressorVisualizer : public juce::Component
 {
@@ -16,10 +28,23 @@ public:
     // Update the visualizer with current compressor settings
     void updateSettings(float threshold, float ratio, float attackTime, float releaseTime);
     
-    // Update with current gain reduction amount
-    void updateGainReduction(float gainReductionDb);
+    // Drain the processor's telemetry each frame - the only source of the history
+    // and gain reduction readout. Pass nullptr to stop.
+    void setTelemetrySource(CompressorProcessor* processor) { telemetrySource = processor; }
     
 private:
+    friend class VisualizerRenderHarness;
+    
+    using Telemetry = CompressorProcessor::Telemetry;
+    
+    // Called by the frame scheduler once per display frame
+    void updateFrame();
+    void addToHistory(const Telemetry& telemetry);
+    void markHistoryDirty();
+    
+    void drawTransferCurve(juce::Graphics& g);
+    void drawHistory(juce::Graphics& g);
+    
     // Compressor parameters
     float threshold = -20.0f;    // dB
     float ratio = 4.0f;          // ratio
@@ -27,5 +52,19 @@ private:
     float release = 100.0f;      // ms
     float currentGainReduction = 0.0f;  // dB
     
+    // Layout
+    juce::Rectangle<int> curveArea, historyArea, readoutArea;
+    
+    // One history column per telemetry column, oldest at historyWritePosition
+    std::vector<Telemetry> history;
+    size_t historyWritePosition = 0;
+    
+    CompressorProcessor* telemetrySource = nullptr;
+    
+    // Background, border, transfer curve and threshold line
+    CachedBackgroundLayer staticLayer;
+    
+    FrameScheduler::Client frameClient { this, [this] { updateFrame(); } };
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CompressorVisualizer)
 };
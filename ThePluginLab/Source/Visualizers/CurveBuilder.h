@@ -0,0 +1,192 @@
+#pragma once
+#include <JuceHeader.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/**
+ * Level-of-detail polyline builder for curves sampled more densely than the display.
+ *
+ * Points are added left to right. All the points that land in the same pixel
+ * column are collapsed to at most four - where the curve enters and leaves the
+ * column, and its minimum and maximum - so spikes and the joins to neighbouring
+ * columns survive. The collapsed curve is then simplified with Ramer-Douglas-
+ * Peucker, dropping any point that is within a sub-pixel tolerance of the line
+ * between the points kept around it. The result looks the same as the full
+ * curve, with a vertex count bounded by the width in pixels rather than by the
+ * number of points added.
+ *
+ * Storage is reused between calls, so keep one builder per curve.
+ */
+class CurveBuilder
+{
+public:
+    explicit CurveBuilder(float toleranceInPixels = 0.25f) { setTolerance(toleranceInPixels); }
+
+    // Maximum distance, in pixels, a dropped point may be from the simplified curve
+    void setTolerance(float toleranceInPixels) noexcept { tolerance = juce::jmax(0.0f, toleranceInPixels); }
+
+    void clear() noexcept
+    {
+        collapsed.clear();
+        simplified.clear();
+        column = {};
+        numPointsAdded = 0;
+    }
+
+    // x must not decrease from one point to the next
+    void addPoint(float x, float y)
+    {
+        jassert(numPointsAdded == 0 || x >= column.last.x);
+
+        const auto columnIndex = (int) std::floor(x);
+        const juce::Point<float> point { x, y };
+
+        if (column.numPoints == 0 || columnIndex != column.index)
+        {
+            flushColumn();
+            column = { columnIndex, 1, point, point, point, point, 0, 0, 0 };
+        }
+        else
+        {
+            column.last = point;
+            column.lastSequence = column.numPoints;
+
+            if (y < column.min.y) { column.min = point; column.minSequence = column.numPoints; }
+            if (y > column.max.y) { column.max = point; column.maxSequence = column.numPoints; }
+
+            ++column.numPoints;
+        }
+
+        ++numPointsAdded;
+    }
+
+    // Simplifies the points added since clear() and appends them to a path,
+    // continuing its current sub-path or starting a new one
+    void appendTo(juce::Path& path, bool startNewSubPath)
+    {
+        simplify();
+
+        if (simplified.empty())
+            return;
+
+        path.preallocateSpace((int) simplified.size() * 3);
+
+        if (startNewSubPath)
+            path.startNewSubPath(simplified.front());
+        else
+            path.lineTo(simplified.front());
+
+        for (size_t i = 1; i < simplified.size(); ++i)
+            path.lineTo(simplified[i]);
+    }
+
+    int getNumPointsAdded() const noexcept { return numPointsAdded; }
+
+    // Valid after appendTo()
+    int getNumPointsDrawn() const noexcept { return (int) simplified.size(); }
+
+private:
+    struct Column
+    {
+        int index = 0;
+        int numPoints = 0;
+        juce::Point<float> first, last, min, max;
+        int lastSequence = 0, minSequence = 0, maxSequence = 0;
+    };
+
+    void flushColumn()
+    {
+        if (column.numPoints == 0)
+            return;
+
+        // Entry, extremes and exit, in the order they were added, each only once
+        std::pair<int, juce::Point<float>> kept[] = { { 0, column.first },
+                                                      { column.minSequence, column.min },
+                                                      { column.maxSequence, column.max },
+                                                      { column.lastSequence, column.last } };
+
+        std::sort(std::begin(kept), std::end(kept),
+                  [] (const auto& a, const auto& b) { return a.first < b.first; });
+
+        for (size_t i = 0; i < 4; ++i)
+            if (i == 0 || kept[i].first != kept[i - 1].first)
+                collapsed.push_back(kept[i].second);
+
+        column.numPoints = 0;
+    }
+
+    void simplify()
+    {
+        flushColumn();
+        simplified.clear();
+
+        if (collapsed.size() < 3)
+        {
+            simplified = collapsed;
+            return;
+        }
+
+        // Iterative Ramer-Douglas-Peucker: keep the point furthest from each
+        // span's chord until every dropped point is within tolerance
+        keep.assign(collapsed.size(), false);
+        keep.front() = keep.back() = true;
+
+        spans.clear();
+        spans.push_back({ 0, collapsed.size() - 1 });
+
+        const auto toleranceSquared = tolerance * tolerance;
+
+        while (! spans.empty())
+        {
+            const auto span = spans.back();
+            spans.pop_back();
+
+            size_t furthest = 0;
+            float furthestDistanceSquared = toleranceSquared;
+
+            for (size_t i = span.first + 1; i < span.second; ++i)
+            {
+                const auto distanceSquared = getDistanceSquaredToSegment(collapsed[i], collapsed[span.first], collapsed[span.second]);
+
+                if (distanceSquared > furthestDistanceSquared)
+                {
+                    furthestDistanceSquared = distanceSquared;
+                    furthest = i;
+                }
+            }
+
+            if (furthest != 0)
+            {
+                keep[furthest] = true;
+                spans.push_back({ span.first, furthest });
+                spans.push_back({ furthest, span.second });
+            }
+        }
+
+        for (size_t i = 0; i < collapsed.size(); ++i)
+            if (keep[i])
+                simplified.push_back(collapsed[i]);
+    }
+
+    static float getDistanceSquaredToSegment(juce::Point<float> point, juce::Point<float> start, juce::Point<float> end) noexcept
+    {
+        const auto segment = end - start;
+        const auto lengthSquared = segment.getDotProduct(segment);
+        auto t = lengthSquared > 0.0f ? (point - start).getDotProduct(segment) / lengthSquared : 0.0f;
+        t = juce::jlimit(0.0f, 1.0f, t);
+
+        const auto offset = point - (start + segment * t);
+        return offset.getDotProduct(offset);
+    }
+
+    float tolerance = 0.25f;
+    Column column;
+    int numPointsAdded = 0;
+
+    std::vector<juce::Point<float>> collapsed, simplified;
+    std::vector<bool> keep;
+    std::vector<std::pair<size_t, size_t>> spans;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CurveBuilder)
+};
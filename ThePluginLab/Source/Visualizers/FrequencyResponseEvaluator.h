@@ -0,0 +1,182 @@
+#pragma once
+#include <JuceHeader.h>
+#include <cmath>
+#include <vector>
+
+/**
+ * Batch magnitude-response evaluator for a chain of biquads.
+ *
+ * The log-spaced frequency table (phi = sin^2(w/2) per point) is built once
+ * per width/sample rate. The squared magnitude of each biquad is evaluated in
+ * closed form on SIMD registers, the bands are multiplied together, and the
+ * result is converted to dB with a single log10 per point. Nothing is
+ * recomputed until the filters or the frequency table change.
+ *
+ * The response is written in terms of phi rather than cos w and cos 2w, and
+ * evaluated in double: near DC the cos form subtracts nearly equal numbers and
+ * loses every significant digit of a low shelf or high-pass in float.
+ *
+ * Message-thread only.
+ */
+class FrequencyResponseEvaluator
+{
+public:
+    // Normalised biquad (a0 == 1). First-order sections use b2 = a2 = 0.
+    struct Biquad
+    {
+        double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+
+        template <typename NumericType>
+        static Biquad fromCoefficients(const juce::dsp::IIR::Coefficients<NumericType>& coefficients)
+        {
+            auto* c = coefficients.getRawCoefficients();
+
+            switch (coefficients.getFilterOrder())
+            {
+                case 1:  return { (double) c[0], (double) c[1], 0.0, (double) c[2], 0.0 };
+                case 2:  return { (double) c[0], (double) c[1], (double) c[2], (double) c[3], (double) c[4] };
+                default: jassertfalse; return {};   // Only first and second order sections are supported
+            }
+        }
+
+        bool operator== (const Biquad& other) const noexcept
+        {
+            return b0 == other.b0 && b1 == other.b1 && b2 == other.b2 && a1 == other.a1 && a2 == other.a2;
+        }
+
+        bool operator!= (const Biquad& other) const noexcept { return ! operator== (other); }
+    };
+
+    FrequencyResponseEvaluator() = default;
+
+    // Rebuilds the frequency table if any of the parameters changed
+    void setFrequencyRange(int numPointsToUse, double sampleRateToUse, float minFrequencyToUse, float maxFrequencyToUse)
+    {
+        numPointsToUse = juce::jmax(2, numPointsToUse);
+
+        if (numPointsToUse == numPoints && sampleRateToUse == sampleRate
+            && minFrequencyToUse == minFrequency && maxFrequencyToUse == maxFrequency)
+            return;
+
+        numPoints = numPointsToUse;
+        sampleRate = sampleRateToUse;
+        minFrequency = minFrequencyToUse;
+        maxFrequency = maxFrequencyToUse;
+
+        const auto numBlocks = (size_t) (numPoints + lanes - 1) / lanes;
+        phi.assign(numBlocks, Vec::expand(0.0));
+        phiSquared.assign(numBlocks, Vec::expand(0.0));
+        numerators.assign(numBlocks, Vec::expand(1.0));
+        denominators.assign(numBlocks, Vec::expand(1.0));
+        decibels.assign((size_t) numPoints, 0.0f);
+
+        const auto nyquist = sampleRate * 0.5;
+
+        for (int i = 0; i < numPoints; ++i)
+        {
+            auto frequency = juce::jmin((double) getFrequency(i), nyquist);
+            auto sinHalfW = std::sin(juce::MathConstants<double>::pi * frequency / sampleRate);
+            auto p = sinHalfW * sinHalfW;
+
+            phi[(size_t) i / lanes].set((size_t) i % lanes, p);
+            phiSquared[(size_t) i / lanes].set((size_t) i % lanes, p * p);
+        }
+
+        needsUpdate = true;
+    }
+
+    void setFilters(const std::vector<Biquad>& newFilters)
+    {
+        if (newFilters == filters)
+            return;
+
+        filters = newFilters;
+        needsUpdate = true;
+    }
+
+    // Recomputes the response if anything changed; returns true if it did
+    bool update()
+    {
+        if (! needsUpdate || numPoints == 0)
+            return false;
+
+        needsUpdate = false;
+
+        // |H|^2 = (n0 + n1 phi + n2 phi^2) / (d0 + d1 phi + d2 phi^2), phi = sin^2(w/2)
+        terms.clear();
+
+        for (const auto& f : filters)
+        {
+            const auto bSum = f.b0 + f.b1 + f.b2;
+            const auto aSum = 1.0 + f.a1 + f.a2;
+
+            terms.push_back({ bSum * bSum,
+                              -4.0 * (f.b0 * f.b1 + 4.0 * f.b0 * f.b2 + f.b1 * f.b2),
+                              16.0 * f.b0 * f.b2,
+                              aSum * aSum,
+                              -4.0 * (f.a1 + 4.0 * f.a2 + f.a1 * f.a2),
+                              16.0 * f.a2 });
+        }
+
+        // SIMDRegister has no division, so numerators and denominators are
+        // accumulated separately and divided once per point below
+        for (size_t block = 0; block < phi.size(); ++block)
+        {
+            auto numerator = Vec::expand(1.0);
+            auto denominator = Vec::expand(1.0);
+            const auto p = phi[block];
+            const auto p2 = phiSquared[block];
+
+            for (const auto& t : terms)
+            {
+                numerator = numerator * (Vec::expand(t.n0) + p * t.n1 + p2 * t.n2);
+                denominator = denominator * (Vec::expand(t.d0) + p * t.d1 + p2 * t.d2);
+            }
+
+            numerators[block] = numerator;
+            denominators[block] = denominator;
+        }
+
+        constexpr double minimumPower = 1.0e-40;
+
+        for (int i = 0; i < numPoints; ++i)
+        {
+            auto numerator = numerators[(size_t) i / lanes].get((size_t) i % lanes);
+            auto denominator = denominators[(size_t) i / lanes].get((size_t) i % lanes);
+
+            decibels[(size_t) i] = (float) (10.0 * std::log10(juce::jmax(minimumPower, numerator)
+                                                               / juce::jmax(minimumPower, denominator)));
+        }
+
+        return true;
+    }
+
+    int getNumPoints() const noexcept { return numPoints; }
+
+    // Summed response in dB, one value per point, valid after update()
+    const float* getDecibels() const noexcept { return decibels.data(); }
+
+    float getFrequency(int index) const noexcept
+    {
+        return minFrequency * std::pow(maxFrequency / minFrequency, (float) index / (float) (numPoints - 1));
+    }
+
+private:
+    using Vec = juce::dsp::SIMDRegister<double>;
+    static constexpr size_t lanes = Vec::SIMDNumElements;
+
+    struct Terms { double n0, n1, n2, d0, d1, d2; };
+
+    int numPoints = 0;
+    double sampleRate = 0.0;
+    float minFrequency = 20.0f, maxFrequency = 20000.0f;
+
+    std::vector<Vec> phi, phiSquared, numerators, denominators;
+    std::vector<float> decibels;
+
+    std::vector<Biquad> filters;
+    std::vector<Terms> terms;
+    bool needsUpdate = true;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FrequencyResponseEvaluator)
+};
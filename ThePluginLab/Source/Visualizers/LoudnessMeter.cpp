@@ -0,0 +1,413 @@
+#include "LoudnessMeter.h"
+#include "../Audio/Graphs/DenormalProtection.h"
+
+LoudnessMeter::LoudnessMeter()
+    : juce::Thread("Loudness meter")
+{
+    prepare(sampleRate, numChannels);
+}
+
+LoudnessMeter::~LoudnessMeter()
+{
+    stopThread(1000);
+}
+
+void LoudnessMeter::prepare(double newSampleRate, int newNumChannels)
+{
+    prepare(newSampleRate, juce::AudioChannelSet::canonicalChannelSet(juce::jmax(1, newNumChannels)));
+}
+
+void LoudnessMeter::prepare(double newSampleRate, const juce::AudioChannelSet& layout)
+{
+    // Larger layouts are measured on their first maxChannels channels only
+    jassert(layout.size() <= maxChannels);
+
+    stopThread(1000);
+
+    sampleRate = newSampleRate;
+    numChannels = juce::jlimit(1, maxChannels, layout.size());
+
+    for (int ch = 0; ch < maxChannels; ++ch)
+        channels[(size_t) ch].weight = ch < layout.size() ? getChannelWeight(layout.getTypeOfChannel(ch)) : 1.0;
+
+    subBlockLength = juce::jmax(1, juce::roundToInt(sampleRate * 0.1));
+
+    for (auto& channelScratch : scratch)
+        channelScratch.resize((size_t) captureBuffer.getCapacity());
+
+    designFilters();
+    designTruePeakFilter();
+    clearState();
+
+    // Only measure what arrives from now on
+    readPosition = captureBuffer.getTotalWritten();
+    resetRequested.store(false, std::memory_order_relaxed);
+
+    startThread();
+}
+
+LoudnessMeter::Readings LoudnessMeter::getReadings() const noexcept
+{
+    Readings readings;
+    readings.momentaryLufs = momentary.load(std::memory_order_relaxed);
+    readings.shortTermLufs = shortTerm.load(std::memory_order_relaxed);
+    readings.integratedLufs = integrated.load(std::memory_order_relaxed);
+    readings.loudnessRangeLu = loudnessRange.load(std::memory_order_relaxed);
+    readings.truePeakDbtp = truePeakDecibels.load(std::memory_order_relaxed);
+    return readings;
+}
+
+void LoudnessMeter::run()
+{
+    // The K-weighting filters' state decays towards zero in silence
+    DenormalProtection::enableForCurrentThread();
+
+    while (! threadShouldExit())
+    {
+        if (analyseAvailableSamples())
+            continue;
+
+        // 20 ms keeps the momentary reading fresh without spinning
+        wait(20);
+    }
+}
+
+bool LoudnessMeter::analyseAvailableSamples()
+{
+    if (resetRequested.exchange(false, std::memory_order_acquire))
+        clearState();
+
+    // Read the same span from every channel
+    auto numRead = captureBuffer.readSince(0, readPosition, scratch[0].data(), (int) scratch[0].size());
+
+    if (numRead <= 0)
+        return false;
+
+    for (int ch = 1; ch < numChannels; ++ch)
+    {
+        auto channelPosition = readPosition - (juce::uint64) numRead;
+        captureBuffer.readSince(ch, channelPosition, scratch[(size_t) ch].data(), numRead);
+    }
+
+    processSamples(numRead);
+    return true;
+}
+
+void LoudnessMeter::clearState()
+{
+    for (auto& channel : channels)
+    {
+        channel.preFilter.clear();
+        channel.highPass.clear();
+        channel.subBlockSquares = 0.0;
+        channel.peakHistory.fill(0.0f);
+        channel.peakHistoryPosition = 0;
+    }
+
+    subBlockEnergies.fill(0.0);
+    subBlockWritePosition = 0;
+    subBlockFill = 0;
+    numSubBlocks = 0;
+
+    momentaryHistogram.clear();
+    shortTermHistogram.clear();
+    truePeak = 0.0f;
+
+    momentary.store(minimumLoudness);
+    shortTerm.store(minimumLoudness);
+    integrated.store(minimumLoudness);
+    loudnessRange.store(0.0f);
+    truePeakDecibels.store(minimumLoudness);
+}
+
+void LoudnessMeter::processSamples(int numSamples)
+{
+    int position = 0;
+
+    while (position < numSamples)
+    {
+        const int count = juce::jmin(numSamples - position, subBlockLength - subBlockFill);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto& channel = channels[(size_t) ch];
+            const auto* samples = scratch[(size_t) ch].data() + position;
+            double squares = 0.0;
+            float peak = truePeak;
+
+            for (int i = 0; i < count; ++i)
+            {
+                auto weighted = channel.highPass.process(channel.preFilter.process((double) samples[i]));
+                squares += weighted * weighted;
+                peak = juce::jmax(peak, processTruePeak(channel, samples[i]));
+            }
+
+            channel.subBlockSquares += squares;
+            truePeak = peak;
+        }
+
+        position += count;
+        subBlockFill += count;
+
+        if (subBlockFill == subBlockLength)
+            completeSubBlock();
+    }
+}
+
+void LoudnessMeter::completeSubBlock()
+{
+    // The block energy is the weighted sum of the channels' mean squares
+    double energy = 0.0;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        energy += channels[(size_t) ch].weight * channels[(size_t) ch].subBlockSquares / subBlockLength;
+        channels[(size_t) ch].subBlockSquares = 0.0;
+    }
+
+    subBlockEnergies[(size_t) subBlockWritePosition] = energy;
+    subBlockWritePosition = (subBlockWritePosition + 1) % numSubBlocksShortTerm;
+    subBlockFill = 0;
+    ++numSubBlocks;
+
+    // Momentary and short-term are plain means over the most recent sub-blocks
+    double momentaryEnergy = 0.0, shortTermEnergy = 0.0;
+
+    for (int i = 0; i < numSubBlocksShortTerm; ++i)
+    {
+        auto value = subBlockEnergies[(size_t) ((subBlockWritePosition - 1 - i + numSubBlocksShortTerm) % numSubBlocksShortTerm)];
+        shortTermEnergy += value;
+
+        if (i < numSubBlocksMomentary)
+            momentaryEnergy += value;
+    }
+
+    momentaryEnergy /= numSubBlocksMomentary;
+    shortTermEnergy /= numSubBlocksShortTerm;
+
+    momentary.store(energyToLoudness(momentaryEnergy), std::memory_order_relaxed);
+    shortTerm.store(energyToLoudness(shortTermEnergy), std::memory_order_relaxed);
+    truePeakDecibels.store(juce::Decibels::gainToDecibels(truePeak, minimumLoudness), std::memory_order_relaxed);
+
+    // Integrated: 400 ms blocks with 75% overlap, i.e. one per sub-block,
+    // absolute gate at -70 LUFS and relative gate 10 LU below the ungated mean
+    if (numSubBlocks >= (juce::uint64) numSubBlocksMomentary)
+    {
+        momentaryHistogram.add(momentaryEnergy);
+
+        juce::uint64 numBlocks = 0;
+        auto ungated = momentaryHistogram.getMeanEnergyAbove(-70.0f, numBlocks);
+
+        if (numBlocks > 0)
+        {
+            auto gated = momentaryHistogram.getMeanEnergyAbove(energyToLoudness(ungated) - 10.0f, numBlocks);
+            integrated.store(numBlocks > 0 ? energyToLoudness(gated) : minimumLoudness, std::memory_order_relaxed);
+        }
+    }
+
+    // Loudness range (EBU Tech 3342): short-term values, relative gate 20 LU
+    // below their mean, range between the 10th and 95th percentiles
+    if (numSubBlocks >= (juce::uint64) numSubBlocksShortTerm)
+    {
+        shortTermHistogram.add(shortTermEnergy);
+
+        juce::uint64 numBlocks = 0;
+        auto ungated = shortTermHistogram.getMeanEnergyAbove(-70.0f, numBlocks);
+
+        if (numBlocks > 0)
+        {
+            auto gate = energyToLoudness(ungated) - 20.0f;
+            auto low = shortTermHistogram.getPercentileAbove(gate, 0.10f);
+            auto high = shortTermHistogram.getPercentileAbove(gate, 0.95f);
+            loudnessRange.store(juce::jmax(0.0f, high - low), std::memory_order_relaxed);
+        }
+    }
+}
+
+void LoudnessMeter::designFilters()
+{
+    // K-weighting stages from BS.1770, re-derived for any sample rate
+    const double pi = juce::MathConstants<double>::pi;
+
+    Biquad shelf;
+    {
+        const double f0 = 1681.974450955533, gain = 3.999843853973347, q = 0.7071752369554196;
+        const double k = std::tan(pi * f0 / sampleRate);
+        const double vh = std::pow(10.0, gain / 20.0);
+        const double vb = std::pow(vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+
+        shelf.b0 = (vh + vb * k / q + k * k) / a0;
+        shelf.b1 = 2.0 * (k * k - vh) / a0;
+        shelf.b2 = (vh - vb * k / q + k * k) / a0;
+        shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+        shelf.a2 = (1.0 - k / q + k * k) / a0;
+    }
+
+    Biquad highPass;
+    {
+        const double f0 = 38.13547087602444, q = 0.5003270373238773;
+        const double k = std::tan(pi * f0 / sampleRate);
+        const double a0 = 1.0 + k / q + k * k;
+
+        highPass.b0 = 1.0;
+        highPass.b1 = -2.0;
+        highPass.b2 = 1.0;
+        highPass.a1 = 2.0 * (k * k - 1.0) / a0;
+        highPass.a2 = (1.0 - k / q + k * k) / a0;
+    }
+
+    for (auto& channel : channels)
+    {
+        channel.preFilter = shelf;
+        channel.highPass = highPass;
+    }
+}
+
+void LoudnessMeter::designTruePeakFilter()
+{
+    // Windowed-sinc interpolator, cut off at the original Nyquist, split into
+    // four phases of 12 taps. Each phase is normalised to unity DC gain.
+    const int numTaps = (int) truePeakTaps.size();
+    const double centre = (numTaps - 1) * 0.5;
+
+    for (int n = 0; n < numTaps; ++n)
+    {
+        const double x = (n - centre) / oversamplingFactor;
+        const double sinc = x == 0.0 ? 1.0 : std::sin(juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+        const double window = 0.5 - 0.5 * std::cos(juce::MathConstants<double>::twoPi * (n + 0.5) / numTaps);
+        truePeakTaps[(size_t) n] = (float) (sinc * window);
+    }
+
+    for (int phase = 0; phase < oversamplingFactor; ++phase)
+    {
+        float sum = 0.0f;
+
+        for (int k = 0; k < tapsPerPhase; ++k)
+            sum += truePeakTaps[(size_t) (phase + k * oversamplingFactor)];
+
+        for (int k = 0; k < tapsPerPhase; ++k)
+            truePeakTaps[(size_t) (phase + k * oversamplingFactor)] /= sum;
+    }
+}
+
+float LoudnessMeter::processTruePeak(ChannelState& channel, float sample) noexcept
+{
+    channel.peakHistory[(size_t) channel.peakHistoryPosition] = sample;
+    channel.peakHistoryPosition = (channel.peakHistoryPosition + 1) % tapsPerPhase;
+
+    float peak = std::abs(sample);
+
+    for (int phase = 0; phase < oversamplingFactor; ++phase)
+    {
+        float value = 0.0f;
+        int index = channel.peakHistoryPosition;
+
+        // Newest sample first
+        for (int k = 0; k < tapsPerPhase; ++k)
+        {
+            index = (index + tapsPerPhase - 1) % tapsPerPhase;
+            value += truePeakTaps[(size_t) (phase + k * oversamplingFactor)] * channel.peakHistory[(size_t) index];
+        }
+
+        peak = juce::jmax(peak, std::abs(value));
+    }
+
+    return peak;
+}
+
+float LoudnessMeter::energyToLoudness(double energy) noexcept
+{
+    if (energy <= 0.0)
+        return minimumLoudness;
+
+    return juce::jmax(minimumLoudness, (float) (-0.691 + 10.0 * std::log10(energy)));
+}
+
+double LoudnessMeter::getChannelWeight(juce::AudioChannelSet::ChannelType type) noexcept
+{
+    using Type = juce::AudioChannelSet::ChannelType;
+
+    switch (type)
+    {
+        // The LFE doesn't count towards loudness
+        case Type::LFE:
+        case Type::LFE2:
+            return 0.0;
+
+        // Surrounds between 60 and 120 degrees from centre. Rear surrounds, as in
+        // 7.1, sit further round and keep the default weight.
+        case Type::leftSurround:
+        case Type::rightSurround:
+        case Type::leftSurroundSide:
+        case Type::rightSurroundSide:
+            return 1.41;
+
+        default:
+            return 1.0;
+    }
+}
+
+//==============================================================================
+int LoudnessMeter::GatingHistogram::binForLoudness(float loudness) noexcept
+{
+    return juce::jlimit(0, numBins - 1, (int) ((loudness - lowestLoudness) * binsPerLu));
+}
+
+void LoudnessMeter::GatingHistogram::add(double energy)
+{
+    auto loudness = energyToLoudness(energy);
+
+    // Absolute gate
+    if (loudness < lowestLoudness)
+        return;
+
+    auto bin = (size_t) binForLoudness(loudness);
+    ++counts[bin];
+    energies[bin] += energy;
+}
+
+void LoudnessMeter::GatingHistogram::clear()
+{
+    counts.fill(0);
+    energies.fill(0.0);
+}
+
+double LoudnessMeter::GatingHistogram::getMeanEnergyAbove(float loudness, juce::uint64& numBlocks) const
+{
+    double total = 0.0;
+    numBlocks = 0;
+
+    for (int bin = binForLoudness(loudness); bin < numBins; ++bin)
+    {
+        total += energies[(size_t) bin];
+        numBlocks += counts[(size_t) bin];
+    }
+
+    return numBlocks > 0 ? total / (double) numBlocks : 0.0;
+}
+
+float LoudnessMeter::GatingHistogram::getPercentileAbove(float gate, float fraction) const
+{
+    const int firstBin = binForLoudness(gate);
+    juce::uint64 total = 0;
+
+    for (int bin = firstBin; bin < numBins; ++bin)
+        total += counts[(size_t) bin];
+
+    if (total == 0)
+        return lowestLoudness;
+
+    const auto target = (juce::uint64) std::ceil((double) total * fraction);
+    juce::uint64 cumulative = 0;
+
+    for (int bin = firstBin; bin < numBins; ++bin)
+    {
+        cumulative += counts[(size_t) bin];
+
+        if (cumulative >= juce::jmax((juce::uint64) 1, target))
+            return lowestLoudness + ((float) bin + 0.5f) / binsPerLu;
+    }
+
+    return highestLoudness;
+}
@@ -0,0 +1,158 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+#include "CaptureRingBuffer.h"
+
+/**
+ * ITU-R BS.1770 / EBU R128 loudness meter, as a data source for the visualizers.
+ *
+ * The audio thread only copies blocks into a capture ring. A background thread
+ * runs the K-weighting filters, sums energy in 100 ms sub-blocks and derives:
+ *  - momentary (400 ms) and short-term (3 s) loudness, from a ring of the last
+ *    30 sub-block energies
+ *  - gated integrated loudness and loudness range, from fixed-size 0.1 LU
+ *    histograms - the memory used is the same after ten seconds or ten hours
+ *  - maximum true peak, from 4x polyphase oversampling
+ *
+ * Layouts up to 7.1 are measured with the BS.1770 channel weights: 1.41 for the
+ * side surrounds, 0 for the LFE (which is left out of the loudness, though not
+ * the true peak) and 1.0 for everything else.
+ *
+ * Readings are published through atomics and can be read from any thread.
+ */
+class LoudnessMeter : private juce::Thread
+{
+public:
+    static constexpr float minimumLoudness = -100.0f;
+
+    struct Readings
+    {
+        float momentaryLufs = minimumLoudness;
+        float shortTermLufs = minimumLoudness;
+        float integratedLufs = minimumLoudness;
+        float loudnessRangeLu = 0.0f;
+        float truePeakDbtp = minimumLoudness;
+    };
+
+    LoudnessMeter();
+    ~LoudnessMeter() override;
+
+    // Message thread. Restarts the analysis thread and clears all readings.
+    // Channels past maxChannels are ignored.
+    void prepare(double sampleRate, const juce::AudioChannelSet& layout);
+
+    // As above, taking the layout JUCE uses by default for that many channels
+    // (mono, stereo, ... 5.1 for six, 7.1 for eight)
+    void prepare(double sampleRate, int numChannels);
+
+    // Safe to call from the audio thread
+    void pushBuffer(const juce::AudioBuffer<float>& buffer) noexcept { captureBuffer.push(buffer); }
+
+    // Clears integrated loudness, LRA and the true-peak hold. Safe to call from any thread.
+    void reset() noexcept { resetRequested.store(true, std::memory_order_release); }
+
+    Readings getReadings() const noexcept;
+
+private:
+    friend class VisualizerRenderHarness;
+
+    static constexpr int maxChannels = 8;   // 7.1
+    static constexpr int numSubBlocksShortTerm = 30;   // 3 s of 100 ms sub-blocks
+    static constexpr int numSubBlocksMomentary = 4;    // 400 ms
+    static constexpr int oversamplingFactor = 4;
+    static constexpr int tapsPerPhase = 12;
+
+    struct Biquad
+    {
+        double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+        double z1 = 0.0, z2 = 0.0;
+
+        double process(double x) noexcept
+        {
+            auto y = b0 * x + z1;
+            z1 = b1 * x - a1 * y + z2;
+            z2 = b2 * x - a2 * y;
+            return y;
+        }
+
+        void clear() noexcept { z1 = z2 = 0.0; }
+    };
+
+    struct ChannelState
+    {
+        Biquad preFilter, highPass;      // K-weighting: high shelf, then RLB high-pass
+        double weight = 1.0;             // BS.1770 channel weight, G_i
+        double subBlockSquares = 0.0;
+
+        std::array<float, tapsPerPhase> peakHistory {};
+        int peakHistoryPosition = 0;
+    };
+
+    // Counts and summed energies of gated blocks in 0.1 LU bins from -70 LUFS
+    class GatingHistogram
+    {
+    public:
+        void add(double energy);
+        void clear();
+
+        // Mean energy of all blocks at or above a loudness, and how many there were
+        double getMeanEnergyAbove(float loudness, juce::uint64& numBlocks) const;
+
+        // Loudness below which the given fraction of blocks at or above a gate fall
+        float getPercentileAbove(float gate, float fraction) const;
+
+    private:
+        static constexpr float lowestLoudness = -70.0f;
+        static constexpr float highestLoudness = 10.0f;
+        static constexpr int binsPerLu = 10;
+        static constexpr int numBins = (int) ((highestLoudness - lowestLoudness) * binsPerLu);
+
+        static int binForLoudness(float loudness) noexcept;
+
+        std::array<juce::uint64, numBins> counts {};
+        std::array<double, numBins> energies {};
+    };
+
+    void run() override;
+
+    // Processes whatever has been captured since the last call; false if there was nothing
+    bool analyseAvailableSamples();
+
+    void clearState();
+    void processSamples(int numSamples);
+    void completeSubBlock();
+    void designFilters();
+    void designTruePeakFilter();
+    float processTruePeak(ChannelState& channel, float sample) noexcept;
+
+    static float energyToLoudness(double energy) noexcept;
+    static double getChannelWeight(juce::AudioChannelSet::ChannelType type) noexcept;
+
+    CaptureRingBuffer captureBuffer { maxChannels, 1 << 16 };
+    juce::uint64 readPosition = 0;
+    std::array<std::vector<float>, maxChannels> scratch;
+
+    double sampleRate = 44100.0;
+    int numChannels = 2;
+    int subBlockLength = 4410;
+    int subBlockFill = 0;
+
+    std::array<ChannelState, maxChannels> channels;
+    std::array<double, numSubBlocksShortTerm> subBlockEnergies {};
+    int subBlockWritePosition = 0;
+    juce::uint64 numSubBlocks = 0;
+
+    GatingHistogram momentaryHistogram;    // Integrated loudness (-10 LU relative gate)
+    GatingHistogram shortTermHistogram;    // Loudness range (-20 LU relative gate)
+
+    std::array<float, oversamplingFactor * tapsPerPhase> truePeakTaps {};
+    float truePeak = 0.0f;
+
+    std::atomic<bool> resetRequested { false };
+    std::atomic<float> momentary { minimumLoudness }, shortTerm { minimumLoudness }, integrated { minimumLoudness };
+    std::atomic<float> loudnessRange { 0.0f }, truePeakDecibels { minimumLoudness };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LoudnessMeter)
+};
@@ -0,0 +1,344 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <cmath>
+#include <vector>
+
+/**
+ * Multi-resolution spectrum analysis for log-frequency displays.
+ *
+ * The input is split into three bands: full rate, and decimated by 4 and 16
+ * through Butterworth anti-aliasing filters. Each band runs its own 1024-point
+ * FFT with 50% overlap, so bass is analysed with 16x the frequency resolution
+ * of treble - 8x that of the single 2048-point FFT this replaces. Every hop of
+ * every band is analysed, so no input goes unseen; when several hops complete
+ * between two updateDisplay() calls their spectra are max-held into one. The
+ * decimated bands fill up 4x and 16x more slowly, so the whole analysis costs
+ * about 1.3 1024-point FFTs per 512 input samples.
+ *
+ * Each decimated band only serves frequencies up to a quarter of its own rate.
+ * Its anti-aliasing filter (12th order, cutoff at 0.3x the band rate) then
+ * attenuates anything that could fold back onto those frequencies by over
+ * 100 dB, below the display floor, while costing under 0.05 dB in the served
+ * range.
+ *
+ * Results are mapped straight to one level per display pixel: each pixel takes
+ * the finest band that covers it, and either the peak of the bins it spans or an
+ * interpolated value where a bin is wider than the pixel. Averaging and
+ * peak-hold are applied per pixel.
+ *
+ * Not thread-safe - feed and read it from the same thread.
+ */
+class MultiResolutionSpectrum
+{
+public:
+    static constexpr int numBands = 3;
+    static constexpr int fftOrder = 10;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int hopSize = fftSize / 2;
+    static constexpr int decimationFactor = 4;
+    static constexpr float minimumDb = -100.0f;
+
+    // Anti-aliasing design for the decimated bands, relative to the band's own sample rate
+    static constexpr double antiAliasingCutoff = 0.3;
+    static constexpr int antiAliasingOrder = 12;
+    static constexpr double highestServedFrequency = 0.25;
+
+    MultiResolutionSpectrum()
+        : fft(fftOrder),
+          window((size_t) fftSize, juce::dsp::WindowingFunction<float>::hann, false),
+          fftBuffer((size_t) fftSize * 2)
+    {
+        for (auto& band : bands)
+        {
+            band.history.assign((size_t) fftSize, 0.0f);
+            band.decibels.assign((size_t) fftSize / 2 + 1, minimumDb);
+        }
+
+        prepare(44100.0);
+    }
+
+    // Designs the anti-aliasing filters for the input rate and clears all state
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+
+        for (int i = 0; i < numBands; ++i)
+        {
+            auto& band = bands[(size_t) i];
+            band.sampleRate = sampleRate / std::pow((double) decimationFactor, i);
+            band.antiAliasing.clear();
+
+            // Each decimated band is low-passed at its parent's rate, well below its own Nyquist
+            if (i > 0)
+            {
+                auto parentRate = bands[(size_t) i - 1].sampleRate;
+                auto sections = juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(
+                    (float) (band.sampleRate * antiAliasingCutoff), parentRate, antiAliasingOrder);
+
+                for (auto* coefficients : sections)
+                    band.antiAliasing.emplace_back(coefficients);
+            }
+        }
+
+        reset();
+        pixelMapNeedsUpdate = true;
+    }
+
+    void reset()
+    {
+        for (auto& band : bands)
+        {
+            std::fill(band.history.begin(), band.history.end(), 0.0f);
+            std::fill(band.decibels.begin(), band.decibels.end(), minimumDb);
+            band.writePosition = 0;
+            band.samplesSinceAnalysis = 0;
+            band.analysedSinceDisplay = false;
+            band.decimationPhase = 0;
+
+            for (auto& filter : band.antiAliasing)
+                filter.reset();
+        }
+
+        std::fill(levels.begin(), levels.end(), minimumDb);
+        std::fill(peaks.begin(), peaks.end(), minimumDb);
+        std::fill(peakAges.begin(), peakAges.end(), 0.0f);
+    }
+
+    // One output level per pixel, log-spaced between the two frequencies
+    void setDisplayRange(int numPixelsToUse, float minFrequencyToUse, float maxFrequencyToUse)
+    {
+        numPixelsToUse = juce::jmax(1, numPixelsToUse);
+
+        if (numPixelsToUse == (int) levels.size() && minFrequencyToUse == minFrequency && maxFrequencyToUse == maxFrequency)
+            return;
+
+        minFrequency = minFrequencyToUse;
+        maxFrequency = maxFrequencyToUse;
+        levels.assign((size_t) numPixelsToUse, minimumDb);
+        peaks.assign((size_t) numPixelsToUse, minimumDb);
+        peakAges.assign((size_t) numPixelsToUse, 0.0f);
+        pixelMapNeedsUpdate = true;
+    }
+
+    // 0 = no averaging, towards 1 = heavier smoothing between frames
+    void setAveraging(float amount) noexcept { averaging = juce::jlimit(0.0f, 0.99f, amount); }
+
+    // Peaks are held for holdSeconds, then fall at decayDbPerSecond. A hold of 0 disables peak-hold.
+    void setPeakHold(float holdSeconds, float decayDbPerSecond) noexcept
+    {
+        peakHoldSeconds = juce::jmax(0.0f, holdSeconds);
+        peakDecayDbPerSecond = juce::jmax(0.0f, decayDbPerSecond);
+    }
+
+    bool isPeakHoldEnabled() const noexcept { return peakHoldSeconds > 0.0f; }
+
+    // Feeds input samples; returns true if any band produced a new spectrum
+    bool process(const float* samples, int numSamples)
+    {
+        bool analysed = false;
+
+        for (int i = 0; i < numSamples; ++i)
+            analysed = addSample(0, samples[i]) || analysed;
+
+        return analysed;
+    }
+
+    // Refreshes the per-pixel levels and peaks; elapsedSeconds drives the peak decay
+    void updateDisplay(float elapsedSeconds)
+    {
+        if (pixelMapNeedsUpdate)
+            updatePixelMap();
+
+        for (size_t p = 0; p < levels.size(); ++p)
+        {
+            const auto value = readPixel(pixelMap[p]);
+            levels[p] = averaging * levels[p] + (1.0f - averaging) * value;
+
+            if (! isPeakHoldEnabled())
+                continue;
+
+            if (levels[p] >= peaks[p])
+            {
+                peaks[p] = levels[p];
+                peakAges[p] = 0.0f;
+            }
+            else
+            {
+                peakAges[p] += elapsedSeconds;
+
+                if (peakAges[p] > peakHoldSeconds)
+                    peaks[p] = juce::jmax(levels[p], peaks[p] - peakDecayDbPerSecond * elapsedSeconds);
+            }
+        }
+
+        // The next hop in each band starts a fresh spectrum
+        for (auto& band : bands)
+            band.analysedSinceDisplay = false;
+    }
+
+    int getNumPixels() const noexcept { return (int) levels.size(); }
+    const float* getLevels() const noexcept { return levels.data(); }
+    const float* getPeaks() const noexcept { return peaks.data(); }
+
+private:
+    struct Band
+    {
+        double sampleRate = 44100.0;
+        std::vector<juce::dsp::IIR::Filter<float>> antiAliasing;   // Applied at the parent band's rate
+        int decimationPhase = 0;
+
+        std::vector<float> history;                                // Circular, fftSize samples
+        int writePosition = 0;
+        int samplesSinceAnalysis = 0;
+        bool analysedSinceDisplay = false;
+
+        std::vector<float> decibels;                               // Max over the hops since the last display, fftSize / 2 + 1 bins
+    };
+
+    struct PixelBins
+    {
+        int band = 0;
+        int firstBin = 0, lastBin = 0;   // Peak over [firstBin, lastBin] when the pixel spans whole bins
+        float fraction = -1.0f;          // Otherwise interpolate between firstBin and firstBin + 1
+    };
+
+    bool addSample(int bandIndex, float sample)
+    {
+        auto& band = bands[(size_t) bandIndex];
+        bool analysed = false;
+
+        band.history[(size_t) band.writePosition] = sample;
+        band.writePosition = (band.writePosition + 1) & (fftSize - 1);
+
+        if (++band.samplesSinceAnalysis >= hopSize)
+        {
+            band.samplesSinceAnalysis = 0;
+            analyse(band);
+            analysed = true;
+        }
+
+        // Filter and decimate into the next band down
+        if (bandIndex + 1 < numBands)
+        {
+            auto& child = bands[(size_t) bandIndex + 1];
+
+            for (auto& filter : child.antiAliasing)
+                sample = filter.processSample(sample);
+
+            if (++child.decimationPhase >= decimationFactor)
+            {
+                child.decimationPhase = 0;
+                analysed = addSample(bandIndex + 1, sample) || analysed;
+            }
+        }
+
+        return analysed;
+    }
+
+    void analyse(Band& band)
+    {
+        // Unwrap the history, oldest first
+        const auto split = (size_t) band.writePosition;
+        std::copy(band.history.begin() + (std::ptrdiff_t) split, band.history.end(), fftBuffer.begin());
+        std::copy(band.history.begin(), band.history.begin() + (std::ptrdiff_t) split,
+                  fftBuffer.begin() + (std::ptrdiff_t) (fftSize - (int) split));
+        std::fill(fftBuffer.begin() + fftSize, fftBuffer.end(), 0.0f);
+
+        window.multiplyWithWindowingTable(fftBuffer.data(), (size_t) fftSize);
+        fft.performFrequencyOnlyForwardTransform(fftBuffer.data(), true);
+
+        // A full-scale sine reads 0 dB through the Hann window's 0.5 coherent gain
+        const auto normalisation = juce::Decibels::gainToDecibels((float) fftSize * 0.25f);
+
+        // The first hop since the last display replaces the previous spectrum, later ones are max-held into it
+        const bool replace = ! band.analysedSinceDisplay;
+        band.analysedSinceDisplay = true;
+
+        for (size_t bin = 0; bin < band.decibels.size(); ++bin)
+        {
+            const auto level = juce::Decibels::gainToDecibels(fftBuffer[bin], minimumDb) - normalisation;
+            band.decibels[bin] = replace ? level : juce::jmax(band.decibels[bin], level);
+        }
+    }
+
+    void updatePixelMap()
+    {
+        pixelMapNeedsUpdate = false;
+        pixelMap.resize(levels.size());
+
+        const auto numPixels = (float) levels.size();
+        const auto ratio = maxFrequency / minFrequency;
+
+        for (size_t p = 0; p < pixelMap.size(); ++p)
+        {
+            const auto low = minFrequency * std::pow(ratio, (float) p / numPixels);
+            const auto high = minFrequency * std::pow(ratio, (float) (p + 1) / numPixels);
+
+            // The most decimated band whose passband still covers this pixel
+            int bandIndex = 0;
+
+            for (int i = numBands - 1; i > 0; --i)
+            {
+                if (high <= (float) (bands[(size_t) i].sampleRate * highestServedFrequency))
+                {
+                    bandIndex = i;
+                    break;
+                }
+            }
+
+            const auto binWidth = (float) bands[(size_t) bandIndex].sampleRate / (float) fftSize;
+            const auto maxBin = fftSize / 2;
+            auto& map = pixelMap[p];
+            map.band = bandIndex;
+
+            if ((high - low) / binWidth >= 1.0f)
+            {
+                map.firstBin = juce::jlimit(0, maxBin, juce::roundToInt(low / binWidth));
+                map.lastBin = juce::jlimit(map.firstBin, maxBin, juce::roundToInt(high / binWidth));
+                map.fraction = -1.0f;
+            }
+            else
+            {
+                const auto centre = std::sqrt(low * high) / binWidth;
+                map.firstBin = juce::jlimit(0, maxBin - 1, (int) centre);
+                map.lastBin = map.firstBin + 1;
+                map.fraction = juce::jlimit(0.0f, 1.0f, centre - (float) map.firstBin);
+            }
+        }
+    }
+
+    float readPixel(const PixelBins& map) const noexcept
+    {
+        const auto& decibels = bands[(size_t) map.band].decibels;
+
+        if (map.fraction >= 0.0f)
+            return decibels[(size_t) map.firstBin]
+                   + map.fraction * (decibels[(size_t) map.lastBin] - decibels[(size_t) map.firstBin]);
+
+        auto value = decibels[(size_t) map.firstBin];
+
+        for (int bin = map.firstBin + 1; bin <= map.lastBin; ++bin)
+            value = juce::jmax(value, decibels[(size_t) bin]);
+
+        return value;
+    }
+
+    double sampleRate = 44100.0;
+    std::array<Band, numBands> bands;
+
+    juce::dsp::FFT fft;
+    juce::dsp::WindowingFunction<float> window;
+    std::vector<float> fftBuffer;
+
+    float minFrequency = 20.0f, maxFrequency = 20000.0f;
+    std::vector<PixelBins> pixelMap;
+    bool pixelMapNeedsUpdate = true;
+
+    std::vector<float> levels, peaks, peakAges;
+    float averaging = 0.7f;
+    float peakHoldSeconds = 1.0f;
+    float peakDecayDbPerSecond = 20.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MultiResolutionSpectrum)
+};
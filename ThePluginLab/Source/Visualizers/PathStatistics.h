@@ -0,0 +1,58 @@
+#pragma once
+#include <JuceHeader.h>
+
+/**
+ * Opt-in counter for the paths the visualizers fill and stroke.
+ *
+ * Visualizers call recordPath() just before drawing a path. While disabled -
+ * the normal case - that is a single flag check; the offscreen render harness
+ * enables it to report how many path vertices each frame produced.
+ *
+ * Message-thread only, like painting.
+ */
+class PathStatistics
+{
+public:
+    struct Counts
+    {
+        int numPaths = 0;
+        int numVertices = 0;   // Curve segments count their control points
+    };
+
+    static void setEnabled(bool shouldBeEnabled) noexcept { enabled = shouldBeEnabled; }
+    static bool isEnabled() noexcept { return enabled; }
+
+    static void recordPath(const juce::Path& path) noexcept
+    {
+        if (! enabled)
+            return;
+
+        juce::Path::Iterator iterator(path);
+
+        while (iterator.next())
+        {
+            switch (iterator.elementType)
+            {
+                case juce::Path::Iterator::startNewSubPath:
+                case juce::Path::Iterator::lineTo:      counts.numVertices += 1; break;
+                case juce::Path::Iterator::quadraticTo: counts.numVertices += 2; break;
+                case juce::Path::Iterator::cubicTo:     counts.numVertices += 3; break;
+                case juce::Path::Iterator::closePath:   break;
+            }
+        }
+
+        ++counts.numPaths;
+    }
+
+    // Returns everything recorded since the last call and starts counting again
+    static Counts getAndReset() noexcept
+    {
+        auto result = counts;
+        counts = {};
+        return result;
+    }
+
+private:
+    static inline bool enabled = false;
+    static inline Counts counts;
+};
@@ -3,52 +3,93 @@
 ResponseCurveComponent::ResponseCurveComponent(EqualizerNode& node)
     : owner(node)
 {
-    startTimerHz(30);
+    owner.addChangeListener(this);
 }
 
 ResponseCurveComponent::~ResponseCurveComponent()
 {
-    stopTimer();
+    owner.removeChangeListener(this);
 }
 
 void ResponseCurveComponent::paint(juce::Graphics& g)
 {
-    g.fillAll(juce::Colours::black);
-    g.setColour(juce::Colours::white);
-    
-    auto bounds = getLocalBounds().toFloat();
-    g.strokePath(responseCurve, juce::PathStrokeType(2.0f));
+    FrameScheduler::Client::ScopedPaintTimer paintTimer(frameClient);
     
-    // Frequency grid
-    g.setColour(juce::Colours::grey);
-    const float frequencies[] = { 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000 };
+    // Background and frequency grid come from the cached layer; only the curve
+    // is stroked each frame
+    gridLayer.draw(g, getLocalBounds(), [] (juce::Graphics& layer, juce::Rectangle<float> bounds)
+    {
+        layer.fillAll(juce::Colours::black);
+        layer.setColour(juce::Colours::grey);
+        
+        const float frequencies[] = { 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000 };
+        
+        for (auto freq : frequencies)
+        {
+            float x = bounds.getX() + std::log10(freq / 20.0f) * bounds.getWidth() / 3.0f;
+            layer.drawVerticalLine(int(x), bounds.getY(), bounds.getBottom());
+        }
+    });
     
-    for (auto freq : frequencies)
+    if (curveNeedsUpdate)
     {
-        float x = bounds.getX() + std::log10(freq / 20.0f) * bounds.getWidth() / 3.0f;
-        g.drawVerticalLine(int(x), bounds.getY(), bounds.getBottom());
+        curveNeedsUpdate = false;
+        updateResponseCurve();
     }
+    
+    g.setColour(juce::Colours::white);
+    g.strokePath(responseCurve, juce::PathStrokeType(2.0f));
+}
+
+void ResponseCurveComponent::resized()
+{
+    curveChanged();
+}
+
+void ResponseCurveComponent::collectActiveFilters(const EQProcessor& eq, std::vector<FrequencyResponseEvaluator::Biquad>& filters)
+{
+    filters.clear();
+    
+    for (int band = 0; band < eq.getNumBands(); ++band)
+        if (eq.isBandActive(band))
+            filters.push_back(FrequencyResponseEvaluator::Biquad::fromCoefficients(*eq.makeCoefficients(band)));
 }
 
-void ResponseCurveComponent::timerCallback()
+void ResponseCurveComponent::updateResponseCurve()
 {
     auto bounds = getLocalBounds().toFloat();
     responseCurve.clear();
     
+    if (bounds.isEmpty())
+        return;
+    
     const float startFreq = 20.0f;
     const float endFreq = 20000.0f;
     
-    responseCurve.startNewSubPath(bounds.getX(), bounds.getCentreY());
+    const auto& eq = owner.getEQProcessor();
+    collectActiveFilters(eq, activeFilters);
     
-    for (float freq = startFreq; freq <= endFreq; freq *= 1.01f)
+    responseEvaluator.setFilters(activeFilters);
+    responseEvaluator.setFrequencyRange((int) bounds.getWidth(), eq.getSampleRate(), startFreq, endFreq);
+    responseEvaluator.update();
+    
+    // The evaluator's points are log-spaced over the same 20 Hz - 20 kHz span as
+    // the grid, so they're evenly spaced in x
+    const auto* decibels = responseEvaluator.getDecibels();
+    const int numPoints = responseEvaluator.getNumPoints();
+    const float xScale = bounds.getWidth() / (float) (numPoints - 1);
+    const float yScale = bounds.getHeight() * 0.5f / displayRangeDb;
+    
+    responseCurve.preallocateSpace(numPoints * 3);
+    
+    for (int i = 0; i < numPoints; ++i)
     {
-        float magnitude = 1.0f; 
+        float x = bounds.getX() + (float) i * xScale;
+        float y = bounds.getCentreY() - decibels[i] * yScale;
         
-        float x = bounds.getX() + std::log10(freq / startFreq) * bounds.getWidth() / 3.0f;
-        float y = bounds.getCentreY() - magnitude * bounds.getHeight() / 2.0f;
-        
-        responseCurve.lineTo(x, y);
+        if (i == 0)
+            responseCurve.startNewSubPath(x, y);
+        else
+            responseCurve.lineTo(x, y);
     }
-    
-    repaint();
-} 
+}
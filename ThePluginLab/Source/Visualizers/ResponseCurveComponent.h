@@ -1,22 +1,51 @@
 #pragma once
 #include <JuceHeader.h>
 #include "../Nodes/EqualizerNode.h"
+#include "../GUI/FrameScheduler.h"
+#include "CachedBackgroundLayer.h"
+#include "FrequencyResponseEvaluator.h"
 
 class EqualizerNode;
 
+/**
+ * Draws the EqualizerNode's combined magnitude response from its real filter
+ * coefficients. The curve is only re-evaluated when the node broadcasts a
+ * change or the component is resized; otherwise it does no work at all.
+ */
 class ResponseCurveComponent : public juce::Component,
-                             public juce::Timer
+                               private juce::ChangeListener
 {
 public:
     explicit ResponseCurveComponent(EqualizerNode& node);
     ~ResponseCurveComponent() override;
 
     void paint(juce::Graphics& g) override;
-    void timerCallback() override;
+    void resized() override;
+    
+    // Request a rebuild of the curve on the next frame
+    void curveChanged() { curveNeedsUpdate = true; frameClient.markDirty(); }
+    
+    // The biquads the curve is drawn from: one per active band, in band order
+    static void collectActiveFilters(const EQProcessor& eq, std::vector<FrequencyResponseEvaluator::Biquad>& filters);
 
 private:
+    void changeListenerCallback(juce::ChangeBroadcaster*) override { curveChanged(); }
+    void updateResponseCurve();
+    
     EqualizerNode& owner;
     juce::Path responseCurve;
+    bool curveNeedsUpdate = true;
+    CachedBackgroundLayer gridLayer;
+    
+    // One point per pixel, evaluated from the node's biquad coefficients
+    FrequencyResponseEvaluator responseEvaluator;
+    std::vector<FrequencyResponseEvaluator::Biquad> activeFilters;
+    
+    // The curve spans +/- this many dB, matching the EQ's gain range
+    static constexpr float displayRangeDb = 24.0f;
+    
+    // No frame callback - repaints are only scheduled when the curve changes
+    FrameScheduler::Client frameClient { this };
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ResponseCurveComponent)
 }; 
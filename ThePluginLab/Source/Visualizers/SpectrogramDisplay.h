@@ -0,0 +1,213 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+#include "CaptureRingBuffer.h"
+#include "../GUI/FrameScheduler.h"
+
+/**
+ * Scrolling spectrogram (waterfall) display.
+ *
+ * Each FFT frame is written as a single column into a circular software image
+ * through a 256-entry colour lookup table; nothing already drawn is ever
+ * re-rendered. Painting draws the image as two slices - oldest columns on the
+ * left, newest on the right - so the cost per frame depends only on the
+ * component's size, not on how much history is kept.
+ */
+class SpectrogramDisplay : public juce::Component
+{
+public:
+    SpectrogramDisplay()
+        : fft(fftOrder),
+          window((size_t) fftSize, juce::dsp::WindowingFunction<float>::hann, false),
+          analysisWindow((size_t) fftSize, 0.0f),
+          fftBuffer((size_t) fftSize * 2, 0.0f)
+    {
+        setOpaque(true);
+        buildColourTable();
+        allocateImage();
+    }
+
+    void paint(juce::Graphics& g) override
+    {
+        FrameScheduler::Client::ScopedPaintTimer paintTimer(frameClient);
+
+        g.fillAll(juce::Colours::black);
+        g.setImageResamplingQuality(juce::Graphics::lowResamplingQuality);
+
+        auto bounds = getLocalBounds();
+        const int numColumns = image.getWidth();
+        const int numOldColumns = numColumns - writeColumn;
+
+        // Oldest columns (from the write position to the end) on the left...
+        const int splitX = juce::roundToInt((float) bounds.getWidth() * (float) numOldColumns / (float) numColumns);
+
+        if (numOldColumns > 0 && splitX > 0)
+            g.drawImage(image, bounds.getX(), bounds.getY(), splitX, bounds.getHeight(),
+                        writeColumn, 0, numOldColumns, numRows);
+
+        // ...then the newest, which wrapped round to the start of the image
+        if (writeColumn > 0 && splitX < bounds.getWidth())
+            g.drawImage(image, bounds.getX() + splitX, bounds.getY(), bounds.getWidth() - splitX, bounds.getHeight(),
+                        0, 0, writeColumn, numRows);
+    }
+
+    // Safe to call from the audio thread; only the first channel is analysed
+    void pushBuffer(const juce::AudioBuffer<float>& buffer) noexcept
+    {
+        captureBuffer.push(buffer);
+    }
+
+    void pushSamples(const float* samples, int numSamples) noexcept
+    {
+        captureBuffer.push(&samples, 1, numSamples);
+    }
+
+    void setSampleRate(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        allocateImage();
+    }
+
+    // Length of history across the full width. Longer histories cost no more to draw.
+    void setHistorySeconds(double seconds)
+    {
+        historySeconds = juce::jmax(0.1, seconds);
+        allocateImage();
+    }
+
+    // Levels mapped onto the colour table, in dB relative to a full-scale sine
+    void setDecibelRange(float newMinimumDb, float newMaximumDb)
+    {
+        minimumDb = newMinimumDb;
+        maximumDb = juce::jmax(newMinimumDb + 1.0f, newMaximumDb);
+    }
+
+private:
+    friend class VisualizerRenderHarness;
+
+    // Called by the frame scheduler at half the display rate
+    void updateFrame()
+    {
+        bool newColumns = false;
+
+        // Fill the tail of the analysis window one hop at a time; each complete hop is one column
+        while (auto numRead = captureBuffer.readSince(0, readPosition,
+                                                      analysisWindow.data() + fftSize - hopSize + hopFill,
+                                                      hopSize - hopFill))
+        {
+            hopFill += numRead;
+
+            if (hopFill < hopSize)
+                continue;
+
+            writeSpectrumColumn();
+            std::copy(analysisWindow.begin() + hopSize, analysisWindow.end(), analysisWindow.begin());
+            hopFill = 0;
+            newColumns = true;
+        }
+
+        if (newColumns)
+            frameClient.markDirty();
+    }
+
+    void writeSpectrumColumn()
+    {
+        std::copy(analysisWindow.begin(), analysisWindow.end(), fftBuffer.begin());
+        std::fill(fftBuffer.begin() + fftSize, fftBuffer.end(), 0.0f);
+
+        window.multiplyWithWindowingTable(fftBuffer.data(), (size_t) fftSize);
+        fft.performFrequencyOnlyForwardTransform(fftBuffer.data(), true);
+
+        // A full-scale sine reads 0 dB through the Hann window's 0.5 coherent gain
+        const auto normalisation = juce::Decibels::gainToDecibels((float) fftSize * 0.25f);
+        const auto scale = (float) (colourTableSize - 1) / (maximumDb - minimumDb);
+
+        juce::Image::BitmapData pixels(image, writeColumn, 0, 1, numRows, juce::Image::BitmapData::writeOnly);
+
+        for (int row = 0; row < numRows; ++row)
+        {
+            const auto& bins = rowBins[(size_t) row];
+            auto magnitude = fftBuffer[(size_t) bins.getStart()];
+
+            for (int bin = bins.getStart() + 1; bin < bins.getEnd(); ++bin)
+                magnitude = juce::jmax(magnitude, fftBuffer[(size_t) bin]);
+
+            const auto level = juce::Decibels::gainToDecibels(magnitude, minimumDb) - normalisation;
+            const auto index = juce::jlimit(0, colourTableSize - 1, (int) ((level - minimumDb) * scale));
+
+            *reinterpret_cast<juce::PixelARGB*>(pixels.getPixelPointer(0, row)) = colourTable[(size_t) index];
+        }
+
+        writeColumn = (writeColumn + 1) % image.getWidth();
+    }
+
+    void allocateImage()
+    {
+        const int numColumns = juce::jmax(2, (int) (historySeconds * sampleRate / hopSize));
+
+        // Software image - columns are written directly, no GPU texture uploads
+        image = juce::Image(juce::Image::ARGB, numColumns, numRows, true, juce::SoftwareImageType());
+        writeColumn = 0;
+
+        // Log-spaced rows, highest frequency at the top; each row takes the
+        // peak of the bins it covers
+        const auto binWidth = sampleRate / fftSize;
+        const auto ratio = maxFrequency / minFrequency;
+        rowBins.resize((size_t) numRows);
+
+        for (int row = 0; row < numRows; ++row)
+        {
+            const auto high = minFrequency * std::pow(ratio, (double) (numRows - row) / numRows);
+            const auto low = minFrequency * std::pow(ratio, (double) (numRows - row - 1) / numRows);
+            const auto firstBin = juce::jlimit(0, fftSize / 2, juce::roundToInt(low / binWidth));
+            const auto endBin = juce::jlimit(firstBin + 1, fftSize / 2 + 1, juce::roundToInt(high / binWidth));
+
+            rowBins[(size_t) row] = { firstBin, endBin };
+        }
+
+        frameClient.markDirty();
+    }
+
+    void buildColourTable()
+    {
+        juce::ColourGradient gradient(juce::Colours::black, 0.0f, 0.0f, juce::Colours::white, 1.0f, 0.0f, false);
+        gradient.addColour(0.25, juce::Colours::darkblue);
+        gradient.addColour(0.5, juce::Colours::purple);
+        gradient.addColour(0.7, juce::Colours::red);
+        gradient.addColour(0.88, juce::Colours::yellow);
+
+        for (int i = 0; i < colourTableSize; ++i)
+            colourTable[(size_t) i] = gradient.getColourAtPosition((double) i / (colourTableSize - 1)).getPixelARGB();
+    }
+
+    static constexpr int fftOrder = 11;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int hopSize = fftSize / 2;
+    static constexpr int numRows = 256;
+    static constexpr int colourTableSize = 256;
+    static constexpr double minFrequency = 20.0;
+    static constexpr double maxFrequency = 20000.0;
+
+    double sampleRate = 44100.0;
+    double historySeconds = 5.0;
+    float minimumDb = -100.0f, maximumDb = 0.0f;
+
+    CaptureRingBuffer captureBuffer { 1, fftSize * 4 };
+    juce::uint64 readPosition = 0;
+    int hopFill = 0;
+
+    juce::dsp::FFT fft;
+    juce::dsp::WindowingFunction<float> window;
+    std::vector<float> analysisWindow;
+    std::vector<float> fftBuffer;
+
+    juce::Image image;
+    int writeColumn = 0;   // Next column to write, which is also the oldest
+    std::vector<juce::Range<int>> rowBins;
+    std::array<juce::PixelARGB, colourTableSize> colourTable;
+
+    FrameScheduler::Client frameClient { this, [this] { updateFrame(); }, 2 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrogramDisplay)
+};
@@ -1,8 +1,12 @@
 #pragma once
 #include <JuceHeader.h>
+#include "CaptureRingBuffer.h"
+#include "MultiResolutionSpectrum.h"
+#include "PathStatistics.h"
+#include "CurveBuilder.h"
+#include "../GUI/FrameScheduler.h"
 
-class SpectrumAnalyzer : public juce::Component,
-                        public juce::Timer
+class SpectrumAnalyzer : public juce::Component
 {
 public:
     SpectrumAnalyzer()
@@ -10,17 +14,12 @@ public:
         fft = std::make_unique<juce::dsp::FFT>(fftOrder);
         window = std::make_unique<juce::dsp::WindowingFunction<float>>(
             fftSize, juce::dsp::WindowingFunction<float>::hann);
-            
-        startTimerHz(30);
-    }
-    
-    ~SpectrumAnalyzer() override
-    {
-        stopTimer();
     }
     
     void paint(juce::Graphics& g) override
     {
+        FrameScheduler::Client::ScopedPaintTimer paintTimer(frameClient);
+        
         g.fillAll(juce::Colours::black);
         
         juce::Path spectrumPath;
@@ -28,7 +27,18 @@ public:
         
         spectrumPath.startNewSubPath(bounds.getX(), bounds.getBottom());
         
-        for (int i = 0; i < scopeSize; ++i)
+        if (analysisMode == AnalysisMode::MultiResolution)
+        {
+            paintMultiResolution(g, spectrumPath, bounds);
+            return;
+        }
+        
+        // Several bins share each pixel column at the top of the log axis, so
+        // only the points that change what is drawn are kept. Bin 0 is DC, which
+        // has no place on a log axis.
+        spectrumCurve.clear();
+        
+        for (int i = 1; i < scopeSize; ++i)
         {
             const float freq = (sampleRate * i) / fftSize;
             const float x = bounds.getX() + bounds.getWidth() * 
@@ -36,9 +46,11 @@ public:
             const float y = bounds.getY() + bounds.getHeight() * 
                 (1.0f - (scopeData[i] + 100.0f) / 100.0f);
                 
-            spectrumPath.lineTo(x, y);
+            spectrumCurve.addPoint(x, y);
         }
         
+        spectrumCurve.appendTo(spectrumPath, false);
+        
         spectrumPath.lineTo(bounds.getRight(), bounds.getBottom());
         spectrumPath.closeSubPath();
         
@@ -46,57 +58,214 @@ public:
             juce::Colours::blue.withAlpha(0.7f), 0, bounds.getBottom(),
             juce::Colours::blue.withAlpha(0.2f), 0, bounds.getY(),
             false));
+        PathStatistics::recordPath(spectrumPath);
         g.fillPath(spectrumPath);
         
         g.setColour(juce::Colours::white.withAlpha(0.7f));
+        PathStatistics::recordPath(spectrumPath);
         g.strokePath(spectrumPath, juce::PathStrokeType(1.0f));
     }
     
+    // Push a whole block at once - at most two memcpys into the capture ring.
+    // Safe to call from the audio thread; only the first channel is analysed.
+    void pushBuffer(const juce::AudioBuffer<float>& buffer) noexcept
+    {
+        captureBuffer.push(buffer);
+    }
+    
+    void pushSamples(const float* samples, int numSamples) noexcept
+    {
+        captureBuffer.push(&samples, 1, numSamples);
+    }
+    
+    // Safe to call from the audio thread. Prefer pushBuffer() for whole blocks.
     void pushNextSampleIntoFifo(float sample) noexcept
     {
-        if (fifoIndex == fftSize)
+        captureBuffer.pushSample(sample);
+    }
+    
+    // Fraction of each analysis window shared with the previous one, 0.5 - 0.75.
+    // Higher overlap updates more smoothly at the cost of more FFTs.
+    void setOverlap(float overlap)
+    {
+        overlap = juce::jlimit(0.5f, 0.75f, overlap);
+        hopSize = juce::jmax(1, juce::roundToInt((float) fftSize * (1.0f - overlap)));
+        restartSingleFFT();
+    }
+    
+    enum class AnalysisMode
+    {
+        SingleFFT,         // One 2048-point FFT, resampled onto the log axis
+        MultiResolution    // Per-pixel log bins from three decimated FFT bands
+    };
+    
+    void setAnalysisMode(AnalysisMode newMode)
+    {
+        analysisMode = newMode;
+        multiResolution.reset();
+        multiResolutionReadPosition = captureBuffer.getTotalWritten();
+        restartSingleFFT();
+        frameClient.markDirty();
+    }
+    
+    AnalysisMode getAnalysisMode() const noexcept { return analysisMode; }
+    
+    // Multi-resolution mode only: 0 = no averaging, towards 1 = heavier smoothing
+    void setAveraging(float amount) { multiResolution.setAveraging(amount); }
+    
+    // Multi-resolution mode only: a hold of 0 disables the peak line
+    void setPeakHold(float holdSeconds, float decayDbPerSecond) { multiResolution.setPeakHold(holdSeconds, decayDbPerSecond); }
+    
+    // Called by the frame scheduler at half the display rate
+    void updateFrame()
+    {
+        if (analysisMode == AnalysisMode::MultiResolution)
+        {
+            updateMultiResolution();
+            return;
+        }
+        
+        // Analyse a window at every hop the audio thread has written since the last
+        // frame, so the overlap set by setOverlap() holds however slowly frames
+        // arrive. The ring's atomic write counter is the only state shared with the
+        // audio thread. fftData doubles as scratch space for the new samples.
+        bool analysed = false;
+        
+        while (auto numRead = captureBuffer.readSince(0, lastAnalysedPosition, fftData, hopSize - samplesSinceHop))
         {
-            if (!nextFFTBlockReady)
+            // The window slides along by one hop as the first samples of the next hop arrive
+            if (samplesSinceHop == 0)
+                std::memmove(analysisWindow, analysisWindow + hopSize, sizeof(float) * (size_t) (fftSize - hopSize));
+            
+            std::memcpy(analysisWindow + fftSize - hopSize + samplesSinceHop, fftData, sizeof(float) * (size_t) numRead);
+            samplesSinceHop += numRead;
+            
+            if (samplesSinceHop == hopSize)
             {
-                juce::zeromem(fftData, sizeof(fftData));
-                memcpy(fftData, fifo, sizeof(fifo));
-                nextFFTBlockReady = true;
+                samplesSinceHop = 0;
+                analyseWindow(! analysed);
+                analysed = true;
             }
-            fifoIndex = 0;
         }
-        fifo[fifoIndex++] = sample;
+        
+        if (analysed)
+            frameClient.markDirty();
     }
     
-    void timerCallback() override
+    void setSampleRate(double rate)
     {
-        if (nextFFTBlockReady)
+        sampleRate = rate;
+        multiResolution.prepare(rate);
+    }
+
+private:
+    friend class VisualizerRenderHarness;
+    
+    // Transforms analysisWindow into scopeData. Later hops in the same frame are
+    // max-held over the first, so short transients between frames still show.
+    void analyseWindow(bool replace)
+    {
+        std::memcpy(fftData, analysisWindow, sizeof(float) * (size_t) fftSize);
+        juce::zeromem(fftData + fftSize, sizeof(float) * (size_t) fftSize);
+        
+        window->multiplyWithWindowingTable(fftData, fftSize);
+        fft->performFrequencyOnlyForwardTransform(fftData);
+        
+        auto mindB = -100.0f;
+        auto maxdB = 0.0f;
+        
+        for (int i = 0; i < scopeSize; ++i)
         {
-            window->multiplyWithWindowingTable(fftData, fftSize);
-            fft->performFrequencyOnlyForwardTransform(fftData);
+            auto skewedProportionX = 1.0f - std::exp(std::log(1.0f - (float)i / (float)scopeSize) * 0.2f);
+            auto fftDataIndex = juce::jlimit(0, fftSize / 2, (int)(skewedProportionX * (float)fftSize * 0.5f));
+            auto level = juce::jmap(juce::jlimit(mindB, maxdB, 
+                juce::Decibels::gainToDecibels(fftData[fftDataIndex]) 
+                    - juce::Decibels::gainToDecibels((float)fftSize)),
+                mindB, maxdB, 0.0f, 1.0f);
             
-            auto mindB = -100.0f;
-            auto maxdB = 0.0f;
+            const auto value = level * 100.0f - 100.0f;
+            scopeData[i] = replace ? value : juce::jmax(scopeData[i], value);
+        }
+    }
+    
+    // Refills the window with the latest samples and starts counting hops from there
+    void restartSingleFFT()
+    {
+        lastAnalysedPosition = captureBuffer.readLatest(0, analysisWindow, fftSize);
+        samplesSinceHop = 0;
+    }
+    
+    void updateMultiResolution()
+    {
+        const auto now = juce::Time::getMillisecondCounterHiRes();
+        const auto elapsedSeconds = lastFrameMs > 0.0 ? (float) ((now - lastFrameMs) * 0.001) : 0.0f;
+        lastFrameMs = now;
+        
+        bool newData = false;
+        
+        while (auto numRead = captureBuffer.readSince(0, multiResolutionReadPosition, fftData, fftSize))
+        {
+            multiResolution.process(fftData, numRead);
+            newData = true;
+        }
+        
+        multiResolution.setDisplayRange(getWidth(), 20.0f, 20000.0f);
+        
+        // Peaks keep decaying while the input is silent
+        if (newData || multiResolution.isPeakHoldEnabled())
+        {
+            multiResolution.updateDisplay(elapsedSeconds);
+            frameClient.markDirty();
+        }
+    }
+    
+    void paintMultiResolution(juce::Graphics& g, juce::Path& spectrumPath, juce::Rectangle<float> bounds)
+    {
+        // Levels are already one per pixel on the log axis
+        const auto numPixels = multiResolution.getNumPixels();
+        const auto* levels = multiResolution.getLevels();
+        const auto* peaks = multiResolution.getPeaks();
+        
+        auto levelToY = [bounds] (float level)
+        {
+            return bounds.getY() + bounds.getHeight() * (1.0f - (juce::jlimit(-100.0f, 0.0f, level) + 100.0f) / 100.0f);
+        };
+        
+        spectrumPath.preallocateSpace(numPixels * 3 + 6);
+        
+        for (int i = 0; i < numPixels; ++i)
+            spectrumPath.lineTo(bounds.getX() + (float) i, levelToY(levels[i]));
+        
+        spectrumPath.lineTo(bounds.getRight(), bounds.getBottom());
+        spectrumPath.closeSubPath();
+        
+        g.setGradientFill(juce::ColourGradient(
+            juce::Colours::blue.withAlpha(0.7f), 0, bounds.getBottom(),
+            juce::Colours::blue.withAlpha(0.2f), 0, bounds.getY(),
+            false));
+        PathStatistics::recordPath(spectrumPath);
+        g.fillPath(spectrumPath);
+        
+        g.setColour(juce::Colours::white.withAlpha(0.7f));
+        PathStatistics::recordPath(spectrumPath);
+        g.strokePath(spectrumPath, juce::PathStrokeType(1.0f));
+        
+        if (multiResolution.isPeakHoldEnabled() && numPixels > 0)
+        {
+            juce::Path peakPath;
+            peakPath.preallocateSpace(numPixels * 3);
+            peakPath.startNewSubPath(bounds.getX(), levelToY(peaks[0]));
             
-            for (int i = 0; i < scopeSize; ++i)
-            {
-                auto skewedProportionX = 1.0f - std::exp(std::log(1.0f - (float)i / (float)scopeSize) * 0.2f);
-                auto fftDataIndex = juce::jlimit(0, fftSize / 2, (int)(skewedProportionX * (float)fftSize * 0.5f));
-                auto level = juce::jmap(juce::jlimit(mindB, maxdB, 
-                    juce::Decibels::gainToDecibels(fftData[fftDataIndex]) 
-                        - juce::Decibels::gainToDecibels((float)fftSize)),
-                    mindB, maxdB, 0.0f, 1.0f);
-                        
-                scopeData[i] = level * 100.0f - 100.0f;
-            }
+            for (int i = 1; i < numPixels; ++i)
+                peakPath.lineTo(bounds.getX() + (float) i, levelToY(peaks[i]));
             
-            nextFFTBlockReady = false;
-            repaint();
+            g.setColour(juce::Colours::yellow.withAlpha(0.6f));
+            PathStatistics::recordPath(peakPath);
+            g.strokePath(peakPath, juce::PathStrokeType(1.0f));
         }
     }
     
-    void setSampleRate(double rate) { sampleRate = rate; }
 
-private:
     static constexpr auto fftOrder = 11;
     static constexpr auto fftSize = 1 << fftOrder;
     static constexpr auto scopeSize = 512;
@@ -104,13 +273,24 @@ private:
     std::unique_ptr<juce::dsp::FFT> fft;
     std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
     
-    float fifo[fftSize];
+    CaptureRingBuffer captureBuffer { 1, fftSize * 2 };
+    juce::uint64 lastAnalysedPosition = 0;
+    int hopSize = fftSize / 4;   // 75% overlap
+    int samplesSinceHop = 0;
+    
+    float analysisWindow[fftSize] = {};   // The latest fftSize samples, oldest first
     float fftData[2 * fftSize];
-    float scopeData[scopeSize];
+    float scopeData[scopeSize] = {};
+    CurveBuilder spectrumCurve;
     
-    int fifoIndex = 0;
-    bool nextFFTBlockReady = false;
     double sampleRate = 44100.0;
     
+    AnalysisMode analysisMode = AnalysisMode::SingleFFT;
+    MultiResolutionSpectrum multiResolution;
+    juce::uint64 multiResolutionReadPosition = 0;
+    double lastFrameMs = 0.0;
+    
+    FrameScheduler::Client frameClient { this, [this] { updateFrame(); }, 2 };
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumAnalyzer)
 };
@@ -0,0 +1,179 @@
+#include "VisualizerDiagnostics.h"
+#include <functional>
+#include <iostream>
+#include <vector>
+#include "FrequencyResponseEvaluator.h"
+#include "ResponseCurveComponent.h"
+
+namespace
+{
+    using Coefficients = juce::dsp::IIR::Coefficients<float>;
+
+    // Largest difference between the evaluator and the reference, and where it happened
+    struct ResponseError
+    {
+        double maxErrorDb = 0.0;
+        float frequency = 0.0f;
+        float evaluatedDb = 0.0f;
+        double referenceDb = 0.0;
+    };
+
+    // Compares the evaluator's summed response for a chain against the product of direct evaluations
+    ResponseError measureResponseError(const std::vector<FrequencyResponseEvaluator::Biquad>& filters,
+                                       const juce::Array<Coefficients::Ptr>& chain, double sampleRate, int numPoints)
+    {
+        FrequencyResponseEvaluator evaluator;
+        evaluator.setFrequencyRange(numPoints, sampleRate, 20.0f, 20000.0f);
+        evaluator.setFilters(filters);
+        evaluator.update();
+
+        ResponseError error;
+
+        for (int i = 0; i < evaluator.getNumPoints(); ++i)
+        {
+            const auto frequency = evaluator.getFrequency(i);
+            double magnitude = 1.0;
+
+            for (auto& coefficients : chain)
+                magnitude *= coefficients->getMagnitudeForFrequency(frequency, sampleRate);
+
+            const auto referenceDb = juce::Decibels::gainToDecibels(magnitude, -400.0);
+            const auto difference = std::abs(evaluator.getDecibels()[i] - referenceDb);
+
+            if (difference > error.maxErrorDb)
+                error = { difference, frequency, evaluator.getDecibels()[i], referenceDb };
+        }
+
+        return error;
+    }
+
+    ResponseError measureResponseError(const juce::Array<Coefficients::Ptr>& chain, double sampleRate, int numPoints)
+    {
+        std::vector<FrequencyResponseEvaluator::Biquad> filters;
+
+        for (auto& coefficients : chain)
+            filters.push_back(FrequencyResponseEvaluator::Biquad::fromCoefficients(*coefficients));
+
+        return measureResponseError(filters, chain, sampleRate, numPoints);
+    }
+
+    // Appends one line per case and returns whether it was within tolerance
+    bool reportResponseError(juce::String& report, const juce::String& name, double sampleRate,
+                             const ResponseError& error, double toleranceDb)
+    {
+        const bool passed = error.maxErrorDb <= toleranceDb;
+
+        report << "  " << juce::String(sampleRate / 1000.0, 1) << " kHz " << name.paddedRight(' ', 28)
+               << " max error " << juce::String(error.maxErrorDb, 6) << " dB at "
+               << juce::String(error.frequency, 1) << " Hz (" << juce::String(error.evaluatedDb, 3)
+               << " vs " << juce::String(error.referenceDb, 3) << ")"
+               << (passed ? "" : "  FAILED") << juce::newLine;
+
+        return passed;
+    }
+
+    // The same tolerance and resolution for every check, roughly one point per pixel of a wide curve
+    constexpr double responseToleranceDb = 0.01;
+    constexpr int numResponsePoints = 1024;
+}
+
+bool VisualizerDiagnostics::handlesCommandLine(const juce::String& commandLine)
+{
+    return commandLine.contains("--check-eq-response");
+}
+
+int VisualizerDiagnostics::runFromCommandLine(const juce::String& commandLine)
+{
+    juce::ArgumentList arguments("ThePluginLab", commandLine);
+    juce::String report;
+    bool passed = true;
+
+    if (arguments.containsOption("--check-eq-response"))
+    {
+        passed = checkEQResponse(report) && passed;
+        passed = checkEQProcessorResponse(report) && passed;
+    }
+
+    std::cout << report << std::flush;
+    return passed ? 0 : 1;
+}
+
+bool VisualizerDiagnostics::checkEQResponse(juce::String& report)
+{
+    report << "EQ response against getMagnitudeForFrequency (" << numResponsePoints << " points, 20 Hz - 20 kHz)" << juce::newLine;
+
+    bool passed = true;
+
+    for (const double sampleRate : { 44100.0, 48000.0, 96000.0 })
+    {
+        // Low bands are where the response used to fall apart, plus one chain of everything
+        const std::pair<const char*, juce::Array<Coefficients::Ptr>> cases[] = {
+            { "low-pass 100 Hz",             { Coefficients::makeLowPass(sampleRate, 100.0f) } },
+            { "high-pass 80 Hz",             { Coefficients::makeHighPass(sampleRate, 80.0f) } },
+            { "first-order high-pass 30 Hz", { Coefficients::makeFirstOrderHighPass(sampleRate, 30.0f) } },
+            { "low shelf 80 Hz +6 dB",       { Coefficients::makeLowShelf(sampleRate, 80.0f, 0.707f, 2.0f) } },
+            { "peak 50 Hz Q4 +6 dB",         { Coefficients::makePeakFilter(sampleRate, 50.0f, 4.0f, 2.0f) } },
+            { "high shelf 8 kHz -6 dB",      { Coefficients::makeHighShelf(sampleRate, 8000.0f, 0.707f, 0.5f) } },
+            { "chain of all of the above",   { Coefficients::makeLowPass(sampleRate, 100.0f),
+                                               Coefficients::makeHighPass(sampleRate, 80.0f),
+                                               Coefficients::makeFirstOrderHighPass(sampleRate, 30.0f),
+                                               Coefficients::makeLowShelf(sampleRate, 80.0f, 0.707f, 2.0f),
+                                               Coefficients::makePeakFilter(sampleRate, 50.0f, 4.0f, 2.0f),
+                                               Coefficients::makeHighShelf(sampleRate, 8000.0f, 0.707f, 0.5f) } }
+        };
+
+        for (const auto& testCase : cases)
+        {
+            const auto error = measureResponseError(testCase.second, sampleRate, numResponsePoints);
+            passed = reportResponseError(report, testCase.first, sampleRate, error, responseToleranceDb) && passed;
+        }
+    }
+
+    report << "  " << (passed ? "passed" : "FAILED") << juce::newLine;
+    return passed;
+}
+
+bool VisualizerDiagnostics::checkEQProcessorResponse(juce::String& report)
+{
+    report << "EQ node response curve against getMagnitudeForFrequency" << juce::newLine;
+
+    bool passed = true;
+
+    for (const double sampleRate : { 44100.0, 48000.0 })
+    {
+        // Each case changes the default bands; band 0 is the 80 Hz low shelf
+        const std::pair<const char*, std::function<void(EQProcessor&)>> cases[] = {
+            { "default bands, all flat",     [](EQProcessor&) {} },
+            { "80 Hz low shelf +6 dB",       [](EQProcessor& eq) { eq.setGain(0, 6.0f); } },
+            { "80 Hz low shelf -12 dB",      [](EQProcessor& eq) { eq.setGain(0, -12.0f); } },
+            { "band 0 as 80 Hz high-pass",   [](EQProcessor& eq) { eq.setFilterType(0, EQProcessor::HighPass); } },
+            { "band 0 as 100 Hz low-pass",   [](EQProcessor& eq) { eq.setFilterType(0, EQProcessor::LowPass);
+                                                                   eq.setFrequency(0, 100.0f); } },
+            { "every band +/-6 dB",          [](EQProcessor& eq) { for (int band = 0; band < 5; ++band)
+                                                                       eq.setGain(band, band % 2 == 0 ? 6.0f : -6.0f); } }
+        };
+
+        for (const auto& testCase : cases)
+        {
+            EQProcessor eq;
+            eq.setSampleRate(sampleRate);
+            testCase.second(eq);
+
+            // The filters exactly as the curve component gathers them, and the same bands as references
+            std::vector<FrequencyResponseEvaluator::Biquad> filters;
+            ResponseCurveComponent::collectActiveFilters(eq, filters);
+
+            juce::Array<Coefficients::Ptr> chain;
+
+            for (int band = 0; band < eq.getNumBands(); ++band)
+                if (eq.isBandActive(band))
+                    chain.add(eq.makeCoefficients(band));
+
+            const auto error = measureResponseError(filters, chain, sampleRate, numResponsePoints);
+            passed = reportResponseError(report, testCase.first, sampleRate, error, responseToleranceDb) && passed;
+        }
+    }
+
+    report << "  " << (passed ? "passed" : "FAILED") << juce::newLine;
+    return passed;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <JuceHeader.h>
+
+/**
+ * Headless accuracy checks for the visualizers' analysis code, run from the
+ * command line and reported on stdout.
+ *
+ *   --check-eq-response Evaluates low and high-frequency filters across the display
+ *                       range with FrequencyResponseEvaluator and fails if any point
+ *                       strays from IIR::Coefficients::getMagnitudeForFrequency by
+ *                       more than 0.01 dB. Then does the same for the curve the
+ *                       EQ node draws, built from real EQProcessor bands - starting
+ *                       from the default 80 Hz low shelf - exactly as
+ *                       ResponseCurveComponent builds it.
+ *
+ * Like the visualizer render harness, nothing here needs a display or an audio device.
+ */
+class VisualizerDiagnostics
+{
+public:
+    // True if the command line asks for one of the checks above
+    static bool handlesCommandLine(const juce::String& commandLine);
+
+    // Runs the requested checks, prints their reports and returns the process exit code
+    static int runFromCommandLine(const juce::String& commandLine);
+
+    // Each check appends to the report and returns false if it failed
+    static bool checkEQResponse(juce::String& report);
+    static bool checkEQProcessorResponse(juce::String& report);
+
+private:
+    VisualizerDiagnostics() = delete;
+};
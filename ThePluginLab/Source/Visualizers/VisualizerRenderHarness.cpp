@@ -0,0 +1,426 @@
+#include "VisualizerRenderHarness.h"
+#include <iostream>
+#include "SpectrumAnalyzer.h"
+#include "SpectrogramDisplay.h"
+#include "CompressorVisualizer.h"
+#include "PathStatistics.h"
+#include "../Audio/Processors/CompressorProcessor.h"
+
+namespace
+{
+    // Splits a frame's audio into callback-sized blocks, as the audio thread would deliver it
+    template <typename Callback>
+    void forEachBlock(juce::AudioBuffer<float>& buffer, int blockSize, Callback&& callback)
+    {
+        for (int start = 0; start < buffer.getNumSamples(); start += blockSize)
+        {
+            juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), buffer.getNumChannels(),
+                                           start, juce::jmin(blockSize, buffer.getNumSamples() - start));
+            callback(block);
+        }
+    }
+
+    // A low shelf, a mid cut and a high shelf, for the EQ response mode
+    std::vector<FrequencyResponseEvaluator::Biquad> createExampleEQ(double sampleRate)
+    {
+        using Coefficients = juce::dsp::IIR::Coefficients<float>;
+        using Biquad = FrequencyResponseEvaluator::Biquad;
+
+        return { Biquad::fromCoefficients(*Coefficients::makeLowShelf(sampleRate, 100.0f, 0.7f, 2.0f)),
+                 Biquad::fromCoefficients(*Coefficients::makePeakFilter(sampleRate, 1000.0f, 1.0f, 0.5f)),
+                 Biquad::fromCoefficients(*Coefficients::makeHighShelf(sampleRate, 8000.0f, 0.7f, 1.5f)) };
+    }
+}
+
+VisualizerRenderHarness::VisualizerRenderHarness(const Options& optionsToUse)
+    : options(optionsToUse)
+{
+}
+
+bool VisualizerRenderHarness::run(std::vector<Result>& results, juce::String& error)
+{
+    if (options.audioFile == juce::File())
+        createSyntheticSignal();
+    else if (! loadAudio(error))
+        return false;
+
+    if (options.outputDirectory != juce::File() && options.outputDirectory.createDirectory().failed())
+    {
+        error = "Couldn't create output directory " + options.outputDirectory.getFullPathName();
+        return false;
+    }
+
+    using Type = AudioVisualizer::VisualizationType;
+
+    const std::pair<Type, const char*> audioVisualizerModes[] = {
+        { Type::Waveform,        "Waveform" },
+        { Type::Spectrum,        "Spectrum" },
+        { Type::EQResponse,      "EQResponse" },
+        { Type::MidSideSpectrum, "MidSideSpectrum" },
+        { Type::Goniometer,      "Goniometer" }
+    };
+
+    for (auto size : options.sizes)
+    {
+        for (const auto& mode : audioVisualizerModes)
+            results.push_back(renderAudioVisualizer(mode.first, mode.second, size));
+
+        results.push_back(renderSpectrumAnalyzer(false, size));
+        results.push_back(renderSpectrumAnalyzer(true, size));
+        results.push_back(renderSpectrogram(1.0, size));
+        results.push_back(renderSpectrogram(10.0, size));
+        results.push_back(renderCompressorVisualizer(size));
+    }
+
+    return true;
+}
+
+bool VisualizerRenderHarness::loadAudio(juce::String& error)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(options.audioFile));
+
+    if (reader == nullptr || reader->lengthInSamples <= 0)
+    {
+        error = "Couldn't read audio from " + options.audioFile.getFullPathName();
+        return false;
+    }
+
+    sampleRate = reader->sampleRate;
+
+    const int numChannels = juce::jlimit(1, AudioVisualizer::maxChannels, (int) reader->numChannels);
+    const int numSamples = juce::jmax(1, (int) (options.durationSeconds * sampleRate));
+    const int fileLength = (int) juce::jmin((juce::int64) numSamples, reader->lengthInSamples);
+
+    audio.setSize(numChannels, numSamples);
+    audio.clear();
+    reader->read(&audio, 0, fileLength, 0, true, true);
+
+    // Short recordings are looped to fill the duration
+    for (int position = fileLength; position < numSamples; position += fileLength)
+        for (int channel = 0; channel < numChannels; ++channel)
+            audio.copyFrom(channel, position, audio, channel, 0, juce::jmin(fileLength, numSamples - position));
+
+    return true;
+}
+
+void VisualizerRenderHarness::createSyntheticSignal()
+{
+    // A logarithmic sine sweep across the audio band, pulsed so the compressor
+    // has something to do. The right channel is delayed by 0.5 ms to give the
+    // stereo displays some width, and both get a little noise.
+    sampleRate = options.syntheticSampleRate;
+
+    const int numSamples = juce::jmax(1, (int) (options.durationSeconds * sampleRate));
+    const double startFrequency = 20.0;
+    const double sweepRate = std::log(20000.0 / startFrequency) / options.durationSeconds;
+    const double delaySeconds = 0.0005;
+
+    // Fixed seed, so every run sees the same signal
+    juce::Random random(1234);
+
+    auto sweep = [&] (double t)
+    {
+        const auto phase = juce::MathConstants<double>::twoPi * startFrequency * (std::exp(sweepRate * t) - 1.0) / sweepRate;
+        const auto envelope = std::fmod(t, 0.5) < 0.25 ? 0.8 : 0.1;
+        return (float) (envelope * std::sin(phase));
+    };
+
+    audio.setSize(2, numSamples);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto t = i / sampleRate;
+        audio.setSample(0, i, sweep(t) + 0.01f * (random.nextFloat() * 2.0f - 1.0f));
+        audio.setSample(1, i, sweep(juce::jmax(0.0, t - delaySeconds)) + 0.01f * (random.nextFloat() * 2.0f - 1.0f));
+    }
+}
+
+VisualizerRenderHarness::Result VisualizerRenderHarness::renderAudioVisualizer(AudioVisualizer::VisualizationType type,
+                                                                               const juce::String& modeName,
+                                                                               juce::Point<int> size)
+{
+    AudioVisualizer visualizer;
+
+    // Analysis is run in step with the frames instead
+    visualizer.analysisThread.stopThread(1000);
+
+    visualizer.setSampleRate(sampleRate);
+    visualizer.setVisualizationType(type);
+    visualizer.setEQFilters(createExampleEQ(sampleRate), sampleRate);
+
+    // Only the spectrum mode draws through the curve builder
+    const auto* curve = type == AudioVisualizer::VisualizationType::Spectrum ? &visualizer.spectrumCurve : nullptr;
+
+    return renderFrames(visualizer, "AudioVisualizer " + modeName, size, [&] (juce::AudioBuffer<float>& frameAudio)
+    {
+        forEachBlock(frameAudio, options.blockSize, [&] (juce::AudioBuffer<float>& block) { visualizer.pushBuffer(block); });
+
+        visualizer.runAnalysis();
+        visualizer.updateFrame();
+    }, curve);
+}
+
+VisualizerRenderHarness::Result VisualizerRenderHarness::renderSpectrumAnalyzer(bool multiResolution, juce::Point<int> size)
+{
+    SpectrumAnalyzer analyzer;
+    analyzer.setSampleRate(sampleRate);
+
+    if (multiResolution)
+        analyzer.setAnalysisMode(SpectrumAnalyzer::AnalysisMode::MultiResolution);
+
+    const juce::String name = multiResolution ? "SpectrumAnalyzer MultiResolution" : "SpectrumAnalyzer SingleFFT";
+
+    // The multi-resolution mode builds its path per pixel, without the curve builder
+    return renderFrames(analyzer, name, size, [&] (juce::AudioBuffer<float>& frameAudio)
+    {
+        forEachBlock(frameAudio, options.blockSize, [&] (juce::AudioBuffer<float>& block) { analyzer.pushBuffer(block); });
+
+        analyzer.updateFrame();
+    }, multiResolution ? nullptr : &analyzer.spectrumCurve);
+}
+
+VisualizerRenderHarness::Result VisualizerRenderHarness::renderSpectrogram(double historySeconds, juce::Point<int> size)
+{
+    SpectrogramDisplay spectrogram;
+    spectrogram.setSampleRate(sampleRate);
+    spectrogram.setHistorySeconds(historySeconds);
+
+    const juce::String name = "SpectrogramDisplay " + juce::String(historySeconds, 0) + "s history";
+
+    return renderFrames(spectrogram, name, size, [&] (juce::AudioBuffer<float>& frameAudio)
+    {
+        forEachBlock(frameAudio, options.blockSize, [&] (juce::AudioBuffer<float>& block) { spectrogram.pushBuffer(block); });
+
+        spectrogram.updateFrame();
+    });
+}
+
+VisualizerRenderHarness::Result VisualizerRenderHarness::renderCompressorVisualizer(juce::Point<int> size)
+{
+    const float threshold = -24.0f, ratio = 4.0f, attackMs = 10.0f, releaseMs = 100.0f;
+
+    // The visualizer is fed the way it is in the app - from a compressor's telemetry
+    CompressorProcessor processor;
+    processor.setThreshold(threshold);
+    processor.setRatio(ratio);
+    processor.setAttack(attackMs);
+    processor.setRelease(releaseMs);
+    processor.prepareToPlay(sampleRate, options.blockSize);
+
+    CompressorVisualizer visualizer;
+    visualizer.updateSettings(threshold, ratio, attackMs, releaseMs);
+    visualizer.setTelemetrySource(&processor);
+
+    // The processor is stereo; mono input is duplicated
+    juce::AudioBuffer<float> stereoBlock(2, options.blockSize);
+    juce::MidiBuffer midi;
+
+    return renderFrames(visualizer, "CompressorVisualizer", size, [&] (juce::AudioBuffer<float>& frameAudio)
+    {
+        forEachBlock(frameAudio, options.blockSize, [&] (juce::AudioBuffer<float>& block)
+        {
+            stereoBlock.setSize(2, block.getNumSamples(), false, false, true);
+
+            for (int channel = 0; channel < 2; ++channel)
+                stereoBlock.copyFrom(channel, 0, block, juce::jmin(channel, block.getNumChannels() - 1), 0, block.getNumSamples());
+
+            processor.processBlock(stereoBlock, midi);
+        });
+
+        visualizer.updateFrame();
+    });
+}
+
+VisualizerRenderHarness::LoudnessResult VisualizerRenderHarness::measureLoudness()
+{
+    LoudnessMeter meter;
+    meter.prepare(sampleRate, audio.getNumChannels());
+
+    // Analysis is run in step with the blocks instead of on the meter's thread
+    meter.stopThread(1000);
+
+    LoudnessResult result;
+    result.audioSeconds = audio.getNumSamples() / sampleRate;
+
+    const auto startMs = juce::Time::getMillisecondCounterHiRes();
+
+    forEachBlock(audio, options.blockSize, [&] (juce::AudioBuffer<float>& block)
+    {
+        meter.pushBuffer(block);
+
+        while (meter.analyseAvailableSamples()) {}
+    });
+
+    result.analysisMs = juce::Time::getMillisecondCounterHiRes() - startMs;
+    result.readings = meter.getReadings();
+    return result;
+}
+
+VisualizerRenderHarness::Result VisualizerRenderHarness::renderFrames(juce::Component& component, const juce::String& name,
+                                                                      juce::Point<int> size, const FeedFunction& feed,
+                                                                      const CurveBuilder* curve)
+{
+    Result result;
+    result.name = name + " " + juce::String(size.x) + "x" + juce::String(size.y);
+
+    component.setSize(size.x, size.y);
+
+    const int samplesPerFrame = juce::jmax(1, juce::roundToInt(sampleRate / options.frameRateHz));
+    const int numFrames = audio.getNumSamples() / samplesPerFrame;
+
+    juce::AudioBuffer<float> frameAudio(audio.getNumChannels(), samplesPerFrame);
+    juce::Image image(juce::Image::ARGB, size.x, size.y, true, juce::SoftwareImageType());
+
+    double totalPaintMs = 0.0;
+    double totalVertices = 0.0;
+    double totalCurvePointsAdded = 0.0;
+    double totalCurvePointsDrawn = 0.0;
+
+    PathStatistics::setEnabled(true);
+
+    for (int frame = 0; frame < numFrames; ++frame)
+    {
+        for (int channel = 0; channel < audio.getNumChannels(); ++channel)
+            frameAudio.copyFrom(channel, 0, audio, channel, frame * samplesPerFrame, samplesPerFrame);
+
+        feed(frameAudio);
+
+        PathStatistics::getAndReset();
+        const auto startMs = juce::Time::getMillisecondCounterHiRes();
+
+        {
+            juce::Graphics g(image);
+            component.paintEntireComponent(g, true);
+        }
+
+        const auto paintMs = juce::Time::getMillisecondCounterHiRes() - startMs;
+        const auto counts = PathStatistics::getAndReset();
+
+        if (frame == 0)
+            result.firstPaintMs = paintMs;
+
+        totalPaintMs += paintMs;
+        totalVertices += counts.numVertices;
+        result.maxPaintMs = juce::jmax(result.maxPaintMs, paintMs);
+        result.maxVertices = juce::jmax(result.maxVertices, counts.numVertices);
+
+        if (curve != nullptr)
+        {
+            totalCurvePointsAdded += curve->getNumPointsAdded();
+            totalCurvePointsDrawn += curve->getNumPointsDrawn();
+        }
+    }
+
+    PathStatistics::setEnabled(false);
+
+    result.numFrames = numFrames;
+
+    if (numFrames > 0)
+    {
+        result.meanPaintMs = totalPaintMs / numFrames;
+        result.meanVertices = totalVertices / numFrames;
+    }
+
+    if (curve != nullptr && numFrames > 0)
+    {
+        result.hasCurve = true;
+        result.meanCurvePointsAdded = totalCurvePointsAdded / numFrames;
+        result.meanCurvePointsDrawn = totalCurvePointsDrawn / numFrames;
+    }
+
+    if (options.outputDirectory != juce::File())
+    {
+        auto file = options.outputDirectory.getChildFile(result.name.replaceCharacter(' ', '_') + ".png");
+        file.deleteFile();
+
+        juce::FileOutputStream stream(file);
+        juce::PNGImageFormat png;
+
+        if (stream.openedOk() && png.writeImageToStream(image, stream))
+            result.snapshot = file;
+    }
+
+    return result;
+}
+
+juce::String VisualizerRenderHarness::formatReport(const std::vector<Result>& results)
+{
+    constexpr int nameWidth = 44;
+
+    juce::String report;
+    report << juce::String("Case").paddedRight(' ', nameWidth)
+           << "  Frames  First ms   Mean ms    Max ms  Mean verts  Max verts  Curve pts added  drawn" << juce::newLine;
+
+    for (const auto& result : results)
+    {
+        report << result.name.paddedRight(' ', nameWidth)
+               << juce::String(result.numFrames).paddedLeft(' ', 8)
+               << juce::String(result.firstPaintMs, 3).paddedLeft(' ', 10)
+               << juce::String(result.meanPaintMs, 3).paddedLeft(' ', 10)
+               << juce::String(result.maxPaintMs, 3).paddedLeft(' ', 10)
+               << juce::String(result.meanVertices, 1).paddedLeft(' ', 12)
+               << juce::String(result.maxVertices).paddedLeft(' ', 11);
+
+        if (result.hasCurve)
+            report << juce::String(result.meanCurvePointsAdded, 1).paddedLeft(' ', 17)
+                   << juce::String(result.meanCurvePointsDrawn, 1).paddedLeft(' ', 7);
+        else
+            report << juce::String("-").paddedLeft(' ', 17) << juce::String("-").paddedLeft(' ', 7);
+
+        if (result.snapshot != juce::File())
+            report << "  " << result.snapshot.getFileName();
+
+        report << juce::newLine;
+    }
+
+    return report;
+}
+
+juce::String VisualizerRenderHarness::formatReport(const LoudnessResult& loudness)
+{
+    const auto& readings = loudness.readings;
+    const auto realTimePercent = 100.0 * loudness.analysisMs / juce::jmax(1.0, loudness.audioSeconds * 1000.0);
+
+    juce::String report;
+    report << "LoudnessMeter: " << juce::String(loudness.audioSeconds, 1) << " s analysed in "
+           << juce::String(loudness.analysisMs, 1) << " ms (" << juce::String(realTimePercent, 3) << "% of real time)" << juce::newLine
+           << "  momentary " << juce::String(readings.momentaryLufs, 1) << " LUFS, short-term "
+           << juce::String(readings.shortTermLufs, 1) << " LUFS, integrated " << juce::String(readings.integratedLufs, 1)
+           << " LUFS, range " << juce::String(readings.loudnessRangeLu, 1) << " LU, true peak "
+           << juce::String(readings.truePeakDbtp, 1) << " dBTP" << juce::newLine;
+
+    return report;
+}
+
+int VisualizerRenderHarness::runFromCommandLine(const juce::String& commandLine)
+{
+    juce::ArgumentList arguments("ThePluginLab", commandLine);
+    auto workingDirectory = juce::File::getCurrentWorkingDirectory();
+
+    Options options;
+
+    if (arguments.containsOption("--audio"))
+        options.audioFile = workingDirectory.getChildFile(arguments.getValueForOption("--audio"));
+
+    if (arguments.containsOption("--output"))
+        options.outputDirectory = workingDirectory.getChildFile(arguments.getValueForOption("--output"));
+
+    VisualizerRenderHarness harness(options);
+    std::vector<Result> results;
+    juce::String error;
+
+    if (! harness.run(results, error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    auto report = formatReport(results);
+    report << juce::newLine << formatReport(harness.measureLoudness());
+
+    std::cout << report << std::flush;
+    return 0;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <JuceHeader.h>
+#include <functional>
+#include <vector>
+#include "AudioVisualizer.h"
+#include "CurveBuilder.h"
+#include "LoudnessMeter.h"
+
+/**
+ * Offscreen render harness for the visualizers.
+ *
+ * Feeds audio - a file, or a synthetic test signal - through the analysis
+ * pipelines of AudioVisualizer, SpectrumAnalyzer, SpectrogramDisplay and
+ * CompressorVisualizer in audio-callback-sized blocks, and paints one display
+ * frame at a time into a juce::Image at fixed sizes. Analysis and frame updates are run synchronously
+ * instead of from the analysis thread and the frame scheduler, so no display or
+ * running message loop is needed.
+ *
+ * For every visualizer, mode and size it reports paint time per frame and the
+ * number of path vertices drawn, and optionally saves the last frame as a PNG
+ * for screenshot comparisons. Cases that draw through a CurveBuilder also report
+ * how many points went into it and how many it drew. The whole component is painted every frame, so
+ * times are an upper bound for visualizers that repaint only their dirty areas.
+ * The spectrogram is rendered with 1 s and 10 s of history, whose paint costs
+ * should match.
+ *
+ * The same audio is also measured by LoudnessMeter, reporting its readings and
+ * how long the analysis took relative to the audio's duration.
+ */
+class VisualizerRenderHarness
+{
+public:
+    struct Options
+    {
+        juce::File audioFile;            // A synthetic signal is used if this is empty
+        juce::File outputDirectory;      // Last frame of each case saved here as PNG, if set
+        double syntheticSampleRate = 48000.0;
+        double durationSeconds = 5.0;    // Recorded audio is looped or truncated to this length
+        double frameRateHz = 60.0;
+        int blockSize = 512;
+        std::vector<juce::Point<int>> sizes { { 320, 180 }, { 1280, 720 } };
+    };
+
+    struct Result
+    {
+        juce::String name;
+        int numFrames = 0;
+        double firstPaintMs = 0.0;       // Includes building any cached layers
+        double meanPaintMs = 0.0;
+        double maxPaintMs = 0.0;
+        double meanVertices = 0.0;
+        int maxVertices = 0;
+        bool hasCurve = false;           // The curve counts below are only set if true
+        double meanCurvePointsAdded = 0.0;
+        double meanCurvePointsDrawn = 0.0;
+        juce::File snapshot;
+    };
+
+    struct LoudnessResult
+    {
+        double audioSeconds = 0.0;
+        double analysisMs = 0.0;
+        LoudnessMeter::Readings readings;
+    };
+
+    explicit VisualizerRenderHarness(const Options& optionsToUse);
+
+    // Renders every case. Returns false, with an error message, if the audio couldn't be loaded.
+    bool run(std::vector<Result>& results, juce::String& error);
+
+    // Runs the loudness meter over the audio loaded by run()
+    LoudnessResult measureLoudness();
+
+    static juce::String formatReport(const std::vector<Result>& results);
+    static juce::String formatReport(const LoudnessResult& loudness);
+
+    // Entry point for "--render-visualizers [--audio <file>] [--output <directory>]".
+    // Prints the report to stdout and returns the process exit code.
+    static int runFromCommandLine(const juce::String& commandLine);
+
+private:
+    // Called once per display frame with that frame's audio, which it may process in place
+    using FeedFunction = std::function<void(juce::AudioBuffer<float>&)>;
+
+    bool loadAudio(juce::String& error);
+    void createSyntheticSignal();
+
+    Result renderAudioVisualizer(AudioVisualizer::VisualizationType type, const juce::String& modeName, juce::Point<int> size);
+    Result renderSpectrumAnalyzer(bool multiResolution, juce::Point<int> size);
+    Result renderSpectrogram(double historySeconds, juce::Point<int> size);
+    Result renderCompressorVisualizer(juce::Point<int> size);
+
+    // curve, if given, is the builder the component draws through; its counts are read after every paint
+    Result renderFrames(juce::Component& component, const juce::String& name,
+                        juce::Point<int> size, const FeedFunction& feed,
+                        const CurveBuilder* curve = nullptr);
+
+    Options options;
+    juce::AudioBuffer<float> audio;
+    double sampleRate = 48000.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VisualizerRenderHarness)
+};
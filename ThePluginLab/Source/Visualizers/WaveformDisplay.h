@@ -1,63 +1,73 @@
 #pragma once
 #include <JuceHeader.h>
+#include "CaptureRingBuffer.h"
+#include "WaveformPyramid.h"
+#include "CachedBackgroundLayer.h"
+#include "../GUI/FrameScheduler.h"
 
 class WaveformDisplay : public juce::Component
 {
 public:
     WaveformDisplay()
     {
-        ringBuffer.resize(bufferSize);
+        readScratch.resize((size_t) captureBuffer.getCapacity());
         setOpaque(true);
     }
     
     void paint(juce::Graphics& g) override
     {
-        g.fillAll(juce::Colours::black);
+        FrameScheduler::Client::ScopedPaintTimer paintTimer(frameClient);
         
-        // Draw grid
-        drawTimeMarkers(g);
-        drawAmplitudeScale(g);
+        // Draw grid - cached, since it only changes with the size or time span
+        gridLayer.draw(g, getLocalBounds(), [this] (juce::Graphics& layer, juce::Rectangle<float>)
+        {
+            layer.fillAll(juce::Colours::black);
+            drawTimeMarkers(layer);
+            drawAmplitudeScale(layer);
+        });
         
-        // Draw waveform
+        // Draw waveform - one min/max span per pixel column
         g.setColour(waveformColor);
-        auto bounds = getLocalBounds().toFloat();
-        juce::Path waveformPath;
-        
-        float x = 0;
-        const float xScale = bounds.getWidth() / static_cast<float>(bufferSize);
+        auto bounds = getLocalBounds();
         const float yScale = bounds.getHeight() / 2.0f;
-        const float centerY = bounds.getCentreY();
+        const float centerY = (float) bounds.getCentreY();
         
-        waveformPath.startNewSubPath(0, centerY);
+        columnSpans.resize((size_t) bounds.getWidth());
+        auto firstColumn = pyramid.getColumnSpans(timeSpan, columnSpans.data(), (int) columnSpans.size());
         
-        for (int i = writePos; i < bufferSize; ++i)
+        for (int x = firstColumn; x < (int) columnSpans.size(); ++x)
         {
-            float y = centerY - (ringBuffer[i] * yScale);
-            waveformPath.lineTo(x, y);
-            x += xScale;
-        }
-        
-        for (int i = 0; i < writePos; ++i)
-        {
-            float y = centerY - (ringBuffer[i] * yScale);
-            waveformPath.lineTo(x, y);
-            x += xScale;
+            const auto& span = columnSpans[(size_t) x];
+            float top = centerY - span.getEnd() * yScale;
+            float bottom = centerY - span.getStart() * yScale;
+            
+            g.fillRect((float) x, top, 1.0f, juce::jmax(1.0f, bottom - top));
         }
-        
-        g.strokePath(waveformPath, juce::PathStrokeType(1.0f));
     }
     
+    // Safe to call from the audio thread
     void pushSample(float sample)
     {
-        ringBuffer[writePos] = sample;
-        writePos = (writePos + 1) % bufferSize;
-        repaint();
+        captureBuffer.pushSample(sample);
+    }
+    
+    void pushBuffer(const juce::AudioBuffer<float>& buffer)
+    {
+        captureBuffer.push(buffer);
+    }
+    
+    // Length of history shown, in samples. Long spans cost no more to draw.
+    void setTimeSpan(int numSamples)
+    {
+        timeSpan = juce::jmax(1, numSamples);
+        gridLayer.invalidate();
+        frameClient.markDirty();
     }
     
     void setWaveformColor(juce::Colour color)
     {
         waveformColor = color;
-        repaint();
+        frameClient.markDirty();
     }
 
     void drawTimeMarkers(juce::Graphics& g)
@@ -68,7 +78,7 @@ public:
         
         // Draw time markers (assuming 44.1kHz sample rate)
         const float msPerSample = 1000.0f / 44100.0f;
-        const float totalTimeMs = msPerSample * bufferSize;
+        const float totalTimeMs = msPerSample * timeSpan;
         
         for (int i = 0; i < 5; ++i)
         {
@@ -101,9 +111,37 @@ public:
     }
 
 private:
+    // Called by the frame scheduler at half the display rate, so repaints are
+    // coalesced rather than issued per sample
+    void updateFrame()
+    {
+        // Fold new samples into the pyramid and repaint only if something arrived
+        bool newData = false;
+        
+        while (auto numRead = captureBuffer.readSince(0, readPosition, readScratch.data(), (int) readScratch.size()))
+        {
+            pyramid.addSamples(readScratch.data(), numRead);
+            newData = true;
+        }
+        
+        if (newData)
+            frameClient.markDirty();
+    }
+    
     static constexpr int bufferSize = 1024;
-    std::vector<float> ringBuffer;
-    int writePos = 0;
+    int timeSpan = bufferSize;
+    
+    CaptureRingBuffer captureBuffer { 1, 16384 };
+    juce::uint64 readPosition = 0;
+    std::vector<float> readScratch;
+    
+    WaveformPyramid pyramid;
+    std::vector<juce::Range<float>> columnSpans;
+    
+    // Time markers and amplitude scale
+    CachedBackgroundLayer gridLayer;
+    
+    FrameScheduler::Client frameClient { this, [this] { updateFrame(); }, 2 };
     juce::Colour waveformColor = juce::Colours::lime;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformDisplay)
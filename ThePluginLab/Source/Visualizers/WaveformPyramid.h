@@ -0,0 +1,166 @@
+#pragma once
+#include <JuceHeader.h>
+#include <vector>
+
+/**
+ * Min/max mip-pyramid of a sample stream for waveform drawing.
+ *
+ * Level 0 holds one min/max pair per sample; each level above halves the
+ * resolution. Samples are folded in incrementally as they arrive, so at any
+ * zoom the renderer reads one or two buckets per pixel column instead of
+ * every sample, and long histories (minutes with the default sizes) cost
+ * the same to draw as a few milliseconds.
+ *
+ * Not thread-safe - feed and query it from the same thread, typically the
+ * message thread reading from a CaptureRingBuffer.
+ */
+class WaveformPyramid
+{
+public:
+    explicit WaveformPyramid(int numLevelsToUse = 16, int bucketsPerLevelToUse = 8192)
+        : bucketsPerLevel(juce::nextPowerOfTwo(juce::jmax(2, bucketsPerLevelToUse))),
+          levels((size_t) juce::jmax(1, numLevelsToUse))
+    {
+        for (auto& level : levels)
+        {
+            level.minima.resize((size_t) bucketsPerLevel);
+            level.maxima.resize((size_t) bucketsPerLevel);
+        }
+    }
+
+    void addSamples(const float* samples, int numSamples)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            addBucket(0, samples[i], samples[i]);
+
+        totalSamples += (juce::uint64) numSamples;
+    }
+
+    void clear()
+    {
+        for (auto& level : levels)
+        {
+            level.numCompleted = 0;
+            level.hasPending = false;
+        }
+
+        totalSamples = 0;
+    }
+
+    juce::uint64 getTotalSamples() const noexcept { return totalSamples; }
+
+    // Longest span of history the top level can describe
+    juce::int64 getMaxHistoryLength() const noexcept
+    {
+        return (juce::int64) bucketsPerLevel << (levels.size() - 1);
+    }
+
+    /**
+     * Fills one min/max span per column covering the most recent numSamplesVisible
+     * samples, oldest on the left. History fills in from the right, so columns with
+     * no data yet form a prefix; returns the index of the first column with data.
+     */
+    int getColumnSpans(juce::int64 numSamplesVisible, juce::Range<float>* columns, int numColumns) const
+    {
+        if (numColumns <= 0)
+            return 0;
+
+        numSamplesVisible = juce::jlimit((juce::int64) 1, getMaxHistoryLength(), numSamplesVisible);
+        const double samplesPerColumn = (double) numSamplesVisible / numColumns;
+
+        // The coarsest level whose buckets are still no wider than a column and which
+        // still holds the whole visible range
+        size_t levelIndex = 0;
+
+        while (levelIndex + 1 < levels.size()
+               && (double) ((juce::int64) 1 << (levelIndex + 1)) <= samplesPerColumn)
+            ++levelIndex;
+
+        while (levelIndex + 1 < levels.size()
+               && ((juce::int64) bucketsPerLevel << levelIndex) < numSamplesVisible)
+            ++levelIndex;
+
+        const auto& level = levels[levelIndex];
+        const auto bucketSize = (juce::int64) 1 << levelIndex;
+
+        // Align the view to the level's last completed bucket; it lags by less than one column
+        const auto viewEnd = (juce::int64) level.numCompleted * bucketSize;
+        const auto viewStart = viewEnd - numSamplesVisible;
+        const auto oldestAvailable = juce::jmax((juce::int64) 0, viewEnd - ((juce::int64) bucketsPerLevel * bucketSize));
+        int firstColumnWithData = numColumns;
+
+        for (int column = 0; column < numColumns; ++column)
+        {
+            auto from = viewStart + (juce::int64) (column * samplesPerColumn);
+            auto to = juce::jmax(from + 1, viewStart + (juce::int64) ((column + 1) * samplesPerColumn));
+
+            from = juce::jmax(from, oldestAvailable);
+
+            auto firstBucket = from / bucketSize;
+            auto lastBucket = juce::jmax(firstBucket, (to + bucketSize - 1) / bucketSize - 1);
+            lastBucket = juce::jmin(lastBucket, (juce::int64) level.numCompleted - 1);
+
+            if (to <= from || lastBucket < firstBucket)
+            {
+                columns[column] = {};
+                continue;
+            }
+
+            auto mask = (juce::int64) bucketsPerLevel - 1;
+            auto low = level.minima[(size_t) (firstBucket & mask)];
+            auto high = level.maxima[(size_t) (firstBucket & mask)];
+
+            for (auto bucket = firstBucket + 1; bucket <= lastBucket; ++bucket)
+            {
+                low = juce::jmin(low, level.minima[(size_t) (bucket & mask)]);
+                high = juce::jmax(high, level.maxima[(size_t) (bucket & mask)]);
+            }
+
+            columns[column] = { low, high };
+            firstColumnWithData = juce::jmin(firstColumnWithData, column);
+        }
+
+        return firstColumnWithData;
+    }
+
+private:
+    struct Level
+    {
+        std::vector<float> minima, maxima;
+        juce::uint64 numCompleted = 0;
+
+        // Half-filled bucket waiting for its partner before moving up a level
+        bool hasPending = false;
+        float pendingMin = 0.0f, pendingMax = 0.0f;
+    };
+
+    void addBucket(size_t levelIndex, float low, float high)
+    {
+        auto& level = levels[levelIndex];
+        auto slot = (size_t) (level.numCompleted & (juce::uint64) (bucketsPerLevel - 1));
+
+        level.minima[slot] = low;
+        level.maxima[slot] = high;
+        ++level.numCompleted;
+
+        if (levelIndex + 1 >= levels.size())
+            return;
+
+        if (! level.hasPending)
+        {
+            level.pendingMin = low;
+            level.pendingMax = high;
+            level.hasPending = true;
+            return;
+        }
+
+        level.hasPending = false;
+        addBucket(levelIndex + 1, juce::jmin(level.pendingMin, low), juce::jmax(level.pendingMax, high));
+    }
+
+    const int bucketsPerLevel;
+    std::vector<Level> levels;
+    juce::uint64 totalSamples = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformPyramid)
+};
@@ -425,14 +425,15 @@ void BlockComponent::mouseDrag(const juce::MouseEvent& e)
     {
         // Update the connector position for drawing
         currentDragPoint_ = e.getPosition();
-        getParentComponent()->repaint(); // Make sure the connection line gets redrawn
+        
+        // Make sure the connection line gets redrawn
+        if (auto* canvas = dynamic_cast<CenterCanvas*>(getParentComponent()))
+            canvas->connectionPreviewChanged();
     }
     else
     {
-        // Normal component dragging
+        // Normal component dragging - moved() lets the canvas redraw the affected connections
         dragger.dragComponent(this, e, nullptr);
-        
-        getParentComponent()->repaint();
     }
 }
 
@@ -468,7 +469,9 @@ void BlockComponent::mouseUp(const juce::MouseEvent& e)
         
         // Reset connecting state
         isConnecting_ = false;
-        getParentComponent()->repaint();
+        
+        if (auto* canvas = dynamic_cast<CenterCanvas*>(getParentComponent()))
+            canvas->connectionPreviewChanged();
     }
     else if (!isInSidebar())
     {
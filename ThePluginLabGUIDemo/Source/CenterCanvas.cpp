@@ -57,158 +57,36 @@ void CenterCanvas::paint(juce::Graphics& g)
     g.fillAll(juce::Colour::fromRGB(255, 255, 255)); // White background
 
     // Draw dotted grid
-    g.setColour(juce::Colours::lightgrey);
-    for (int x = 0; x < getWidth(); x += gridSize)
-    {
-        for (int y = 0; y < getHeight(); y += gridSize)
-        {
-            g.fillEllipse((float)x, (float)y, 2.0f, 2.0f); // Dots for the grid
-        }
-    }
+    drawGridDots(g);
     
-    // Draw connections between blocks with updated connector positions
-    g.setColour(juce::Colours::black);
+    // Draw connections between blocks, skipping any outside the area being repainted
     for (int i = 0; i < connections.size(); ++i)
     {
-        auto& connection = connections.getReference(i);
+        auto path = createConnectionPath(connections.getReference(i));
         
-        if (connection.sourceBlock != nullptr && connection.destBlock != nullptr)
+        if (path.isEmpty() || ! g.clipRegionIntersects(getPathArea(path)))
+            continue;
+        
+        // Draw the path with a thicker line - highlight if this is the highlighted connection
+        if (i == highlightedConnectionIndex)
         {
-            // Get the correct connector positions based on stored position values
-            // Convert stored integer positions to BlockComponent::ConnectorPosition enum
-            auto sourceConnPos = static_cast<BlockComponent::ConnectorPosition>(connection.sourceConnectorPosition);
-            auto destConnPos = static_cast<BlockComponent::ConnectorPosition>(connection.destConnectorPosition);
-            
-            // Get absolute coordinates of the connectors
-            juce::Point<float> startPoint = connection.sourceBlock->getPosition().toFloat() + 
-                                          connection.sourceBlock->getConnectorCentre(sourceConnPos).toFloat();
-            
-            juce::Point<float> endPoint = connection.destBlock->getPosition().toFloat() + 
-                                        connection.destBlock->getConnectorCentre(destConnPos).toFloat();
-            
-            float distance = startPoint.getDistanceFrom(endPoint);
-            
-            if (distance > 0)
-            {
-                // Calculate control points for a nice curve based on connector positions
-                juce::Point<float> control1, control2;
-                
-                // Calculate tangent vectors based on connector orientation
-                float sourceOffsetX = 0.0f, sourceOffsetY = 0.0f;
-                float destOffsetX = 0.0f, destOffsetY = 0.0f;
-                
-                // Set source and destination tangent direction based on connector position
-                switch (sourceConnPos)
-                {
-                    case BlockComponent::Left:
-                        sourceOffsetX = -80.0f;
-                        break;
-                    case BlockComponent::Right:
-                        sourceOffsetX = 80.0f;
-                        break;
-                    case BlockComponent::Top:
-                        sourceOffsetY = -80.0f;
-                        break;
-                    case BlockComponent::Bottom:
-                        sourceOffsetY = 80.0f;
-                        break;
-                }
-                
-                switch (destConnPos)
-                {
-                    case BlockComponent::Left:
-                        destOffsetX = -80.0f;
-                        break;
-                    case BlockComponent::Right:
-                        destOffsetX = 80.0f;
-                        break;
-                    case BlockComponent::Top:
-                        destOffsetY = -80.0f;
-                        break;
-                    case BlockComponent::Bottom:
-                        destOffsetY = 80.0f;
-                        break;
-                }
-                
-                // Scale down the offset based on distance to avoid extreme curves
-                float scale = juce::jmin(1.0f, distance / 200.0f);
-                sourceOffsetX *= scale;
-                sourceOffsetY *= scale;
-                destOffsetX *= scale;
-                destOffsetY *= scale;
-                
-                // Calculate control points
-                control1 = startPoint + juce::Point<float>(sourceOffsetX, sourceOffsetY);
-                control2 = endPoint + juce::Point<float>(destOffsetX, destOffsetY);
-                
-                // Create a path for the connection
-                juce::Path path;
-                path.startNewSubPath(startPoint);
-                path.cubicTo(control1, control2, endPoint);
-                
-                // Draw the path with a thicker line - highlight if this is the highlighted connection
-                if (i == highlightedConnectionIndex)
-                {
-                    g.setColour(juce::Colours::orange);
-                    g.strokePath(path, juce::PathStrokeType(4.0f, juce::PathStrokeType::curved, juce::PathStrokeType::rounded));
-                }
-                else
-                {
-                    g.setColour(juce::Colours::black);
-                    g.strokePath(path, juce::PathStrokeType(2.5f, juce::PathStrokeType::curved, juce::PathStrokeType::rounded));
-                }
-            }
+            g.setColour(juce::Colours::orange);
+            g.strokePath(path, juce::PathStrokeType(4.0f, juce::PathStrokeType::curved, juce::PathStrokeType::rounded));
+        }
+        else
+        {
+            g.setColour(juce::Colours::black);
+            g.strokePath(path, juce::PathStrokeType(2.5f, juce::PathStrokeType::curved, juce::PathStrokeType::rounded));
         }
     }
     
-    // Draw in-progress connections with updated connector positions
+    // Draw in-progress connections
+    g.setColour(juce::Colours::darkgrey.withAlpha(0.7f));
+    
     for (auto* block : blocks)
     {
         if (block->isConnecting())
-        {
-            // Calculate start position based on which connector is being dragged
-            juce::Point<float> startPos = block->getPosition().toFloat();
-            auto connectorPos = block->getActiveConnectorPosition();
-            startPos += block->getConnectorCentre(connectorPos).toFloat();
-                
-            // Calculate end position - mouse position
-            juce::Point<float> endPos = block->getPosition().toFloat() + block->getCurrentDragPoint().toFloat();
-            
-            // Draw in-progress connection
-            g.setColour(juce::Colours::darkgrey.withAlpha(0.7f));
-            
-            // Create path for the connection line
-            juce::Path path;
-            
-            // Create a tangent vector based on connector position
-            float offsetX = 0.0f, offsetY = 0.0f;
-            switch (connectorPos)
-            {
-                case BlockComponent::Left:
-                    offsetX = -40.0f;
-                    break;
-                case BlockComponent::Right:
-                    offsetX = 40.0f;
-                    break;
-                case BlockComponent::Top:
-                    offsetY = -40.0f;
-                    break;
-                case BlockComponent::Bottom:
-                    offsetY = 40.0f;
-                    break;
-            }
-            
-            // Create control points for the bezier curve
-            juce::Point<float> control1 = startPos + juce::Point<float>(offsetX, offsetY);
-            juce::Point<float> control2 = endPos + juce::Point<float>(-offsetX * 0.5f, -offsetY * 0.5f);
-            
-            // Create the curved path
-            path.startNewSubPath(startPos);
-            path.cubicTo(control1, control2, endPos);
-            
-            // Draw the path
-            g.strokePath(path, juce::PathStrokeType(2.0f, juce::PathStrokeType::curved, juce::PathStrokeType::rounded));
-        }
+            g.strokePath(createConnectionPreviewPath(*block), juce::PathStrokeType(2.0f, juce::PathStrokeType::curved, juce::PathStrokeType::rounded));
     }
     
     // Draw trash icon with rounded rectangle
@@ -588,6 +466,172 @@ void CenterCanvas::drawGrid(juce::Graphics& g)
     }
 }
 
+void CenterCanvas::drawGridDots(juce::Graphics& g)
+{
+    if (gridSize <= 0)
+        return;
+    
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    
+    // Render a single grid dot at the display's pixel density, once per grid size and scale
+    if (! gridTile.isValid() || gridTileSize != gridSize || gridTileScale != scale)
+    {
+        const int tilePixels = juce::jmax(1, juce::roundToInt((float)gridSize * scale));
+        
+        gridTile = juce::Image(juce::Image::ARGB, tilePixels, tilePixels, true);
+        juce::Graphics tile(gridTile);
+        tile.addTransform(juce::AffineTransform::scale((float)tilePixels / (float)gridSize));
+        tile.setColour(juce::Colours::lightgrey);
+        tile.fillEllipse(0.0f, 0.0f, 2.0f, 2.0f);
+        
+        gridTileSize = gridSize;
+        gridTileScale = scale;
+    }
+    
+    // Tile it from the canvas origin over just the area being repainted
+    juce::Graphics::ScopedSaveState state(g);
+    g.setFillType(juce::FillType(gridTile, juce::AffineTransform::scale((float)gridSize / (float)gridTile.getWidth())));
+    g.fillRect(g.getClipBounds());
+}
+
+juce::Path CenterCanvas::createConnectionPath(const BlockConnection& connection) const
+{
+    juce::Path path;
+    
+    if (connection.sourceBlock == nullptr || connection.destBlock == nullptr)
+        return path;
+    
+    // Get the correct connector positions based on stored position values
+    // Convert stored integer positions to BlockComponent::ConnectorPosition enum
+    auto sourceConnPos = static_cast<BlockComponent::ConnectorPosition>(connection.sourceConnectorPosition);
+    auto destConnPos = static_cast<BlockComponent::ConnectorPosition>(connection.destConnectorPosition);
+    
+    // Get absolute coordinates of the connectors
+    juce::Point<float> startPoint = connection.sourceBlock->getPosition().toFloat() + 
+                                  connection.sourceBlock->getConnectorCentre(sourceConnPos).toFloat();
+    
+    juce::Point<float> endPoint = connection.destBlock->getPosition().toFloat() + 
+                                connection.destBlock->getConnectorCentre(destConnPos).toFloat();
+    
+    float distance = startPoint.getDistanceFrom(endPoint);
+    
+    if (distance <= 0)
+        return path;
+    
+    // Calculate tangent vectors based on connector orientation
+    float sourceOffsetX = 0.0f, sourceOffsetY = 0.0f;
+    float destOffsetX = 0.0f, destOffsetY = 0.0f;
+    
+    // Set source and destination tangent direction based on connector position
+    switch (sourceConnPos)
+    {
+        case BlockComponent::Left:
+            sourceOffsetX = -80.0f;
+            break;
+        case BlockComponent::Right:
+            sourceOffsetX = 80.0f;
+            break;
+        case BlockComponent::Top:
+            sourceOffsetY = -80.0f;
+            break;
+        case BlockComponent::Bottom:
+            sourceOffsetY = 80.0f;
+            break;
+    }
+    
+    switch (destConnPos)
+    {
+        case BlockComponent::Left:
+            destOffsetX = -80.0f;
+            break;
+        case BlockComponent::Right:
+            destOffsetX = 80.0f;
+            break;
+        case BlockComponent::Top:
+            destOffsetY = -80.0f;
+            break;
+        case BlockComponent::Bottom:
+            destOffsetY = 80.0f;
+            break;
+    }
+    
+    // Scale down the offset based on distance to avoid extreme curves
+    float scale = juce::jmin(1.0f, distance / 200.0f);
+    sourceOffsetX *= scale;
+    sourceOffsetY *= scale;
+    destOffsetX *= scale;
+    destOffsetY *= scale;
+    
+    // Calculate control points for a nice curve based on connector positions
+    juce::Point<float> control1 = startPoint + juce::Point<float>(sourceOffsetX, sourceOffsetY);
+    juce::Point<float> control2 = endPoint + juce::Point<float>(destOffsetX, destOffsetY);
+    
+    path.startNewSubPath(startPoint);
+    path.cubicTo(control1, control2, endPoint);
+    return path;
+}
+
+juce::Path CenterCanvas::createConnectionPreviewPath(BlockComponent& block) const
+{
+    // Calculate start position based on which connector is being dragged
+    juce::Point<float> startPos = block.getPosition().toFloat();
+    auto connectorPos = block.getActiveConnectorPosition();
+    startPos += block.getConnectorCentre(connectorPos).toFloat();
+        
+    // Calculate end position - mouse position
+    juce::Point<float> endPos = block.getPosition().toFloat() + block.getCurrentDragPoint().toFloat();
+    
+    // Create a tangent vector based on connector position
+    float offsetX = 0.0f, offsetY = 0.0f;
+    switch (connectorPos)
+    {
+        case BlockComponent::Left:
+            offsetX = -40.0f;
+            break;
+        case BlockComponent::Right:
+            offsetX = 40.0f;
+            break;
+        case BlockComponent::Top:
+            offsetY = -40.0f;
+            break;
+        case BlockComponent::Bottom:
+            offsetY = 40.0f;
+            break;
+    }
+    
+    // Create control points for the bezier curve
+    juce::Point<float> control1 = startPos + juce::Point<float>(offsetX, offsetY);
+    juce::Point<float> control2 = endPos + juce::Point<float>(-offsetX * 0.5f, -offsetY * 0.5f);
+    
+    // Create the curved path
+    juce::Path path;
+    path.startNewSubPath(startPos);
+    path.cubicTo(control1, control2, endPos);
+    return path;
+}
+
+juce::Rectangle<int> CenterCanvas::getPathArea(const juce::Path& path)
+{
+    // Padded for the widest (highlighted) stroke and anti-aliasing
+    return path.getBounds().expanded(3.0f).getSmallestIntegerContainer();
+}
+
+void CenterCanvas::connectionPreviewChanged()
+{
+    juce::Rectangle<int> newArea;
+    
+    for (auto* block : blocks)
+    {
+        if (block->isConnecting())
+            newArea = newArea.getUnion(getPathArea(createConnectionPreviewPath(*block)));
+    }
+    
+    // Only where the preview was and where it is now
+    repaint(previewArea);
+    repaint(newArea);
+    previewArea = newArea;
+}
+
 void CenterCanvas::connectBlocks(BlockComponent* sourceBlock, BlockComponent* destBlock, int connectorPosition)
 {
     if (sourceBlock != nullptr && destBlock != nullptr)
@@ -637,10 +681,11 @@ void CenterCanvas::connectBlocks(BlockComponent* sourceBlock, BlockComponent* de
             }
             
             connection.destConnectorPosition = static_cast<int>(destPos);
+            connection.area = getPathArea(createConnectionPath(connection));
             connections.add(connection);
             
             // Repaint to show the connection
-            repaint();
+            repaint(connection.area);
         }
     }
     
@@ -743,8 +788,19 @@ void CenterCanvas::blockMoved()
         }
     }
     
-    // Redraw to update all connections
-    repaint();
+    // Redraw only the connections whose curves moved, where they were and where they are now.
+    // The moved block repaints its own old and new bounds.
+    for (auto& connection : connections)
+    {
+        auto newArea = getPathArea(createConnectionPath(connection));
+        
+        if (newArea != connection.area)
+        {
+            repaint(connection.area);
+            repaint(newArea);
+            connection.area = newArea;
+        }
+    }
 }
 
 bool CenterCanvas::isPointInDeleteArea(const juce::Point<int>& point) const
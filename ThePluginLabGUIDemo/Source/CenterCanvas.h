@@ -17,6 +17,7 @@ public:
         BlockComponent* destBlock = nullptr;
         int sourceConnectorPosition = 0; 
         int destConnectorPosition = 0;
+        juce::Rectangle<int> area; // Last repainted area of the curve, in canvas coordinates
     };
 
     //==============================================================================
@@ -64,6 +65,9 @@ public:
     // Method to notify that a block was moved
     void blockMoved();
 
+    // Method to notify that a block's in-progress connection changed
+    void connectionPreviewChanged();
+
     // Method to remove a block
     void removeBlock(BlockComponent* blockToRemove);
     
@@ -111,6 +115,22 @@ private:
 
     // Add a tracked dragging block pointer
     BlockComponent* currentlyDraggedCanvasBlock = nullptr;
+
+    // Connection curves, shared by paint() and the dirty-area tracking
+    juce::Path createConnectionPath(const BlockConnection& connection) const;
+    juce::Path createConnectionPreviewPath(BlockComponent& block) const;
+    static juce::Rectangle<int> getPathArea(const juce::Path& path);
+
+    // Fills the background with the cached grid tile
+    void drawGridDots(juce::Graphics& g);
+
+    // Last repainted area of the in-progress connections
+    juce::Rectangle<int> previewArea;
+
+    // One cell of the dotted grid, rendered at the display scale and tiled by drawGridDots
+    juce::Image gridTile;
+    int gridTileSize = 0;
+    float gridTileScale = 0.0f;
     
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CenterCanvas)
@@ -7,9 +7,6 @@ SpectrumVisualizer::SpectrumVisualizer()
     // Set default size
     setSize(300, 200);
     
-    // Start the timer to update the animation
-    startTimerHz(30); // 30 fps
-    
     // Set default filter band
     FilterBand defaultBand;
     defaultBand.frequency = frequency;
@@ -47,19 +44,37 @@ void SpectrumVisualizer::paint(juce::Graphics& g)
     hexagon.lineTo(x, y + h * 0.5f);
     hexagon.closeSubPath();
     
-    // Fill the hexagon with a dark background
-    g.setColour(juce::Colours::black.withAlpha(0.8f));
-    g.fillPath(hexagon);
-    
     // Create a slightly inset bounds for the grid and curves
     auto innerBounds = bounds.reduced(10.0f);
     
-    // Draw grid
-    drawBackgroundGrid(g, innerBounds);
+    // The hexagon background, grid and scales only change with the size, so they're
+    // rendered once at the display's resolution and just composited each frame
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    
+    if (! backgroundCache.isValid() || scale != backgroundCacheScale)
+    {
+        backgroundCacheScale = scale;
+        backgroundCache = juce::Image(juce::Image::ARGB,
+                                      juce::jmax(1, juce::roundToInt(getWidth() * scale)),
+                                      juce::jmax(1, juce::roundToInt(getHeight() * scale)),
+                                      true);
+        
+        juce::Graphics cacheGraphics(backgroundCache);
+        cacheGraphics.addTransform(juce::AffineTransform::scale(scale));
+        
+        // Fill the hexagon with a dark background
+        cacheGraphics.setColour(juce::Colours::black.withAlpha(0.8f));
+        cacheGraphics.fillPath(hexagon);
+        
+        // Draw grid
+        drawBackgroundGrid(cacheGraphics, innerBounds);
+        
+        // Draw scales
+        drawFrequencyScale(cacheGraphics, innerBounds);
+        drawGainScale(cacheGraphics, innerBounds);
+    }
     
-    // Draw scales
-    drawFrequencyScale(g, innerBounds);
-    drawGainScale(g, innerBounds);
+    g.drawImageTransformed(backgroundCache, juce::AffineTransform::scale(1.0f / scale));
     
     // Draw the frequency response curve
     drawResponseCurve(g, innerBounds);
@@ -76,7 +91,8 @@ void SpectrumVisualizer::paint(juce::Graphics& g)
 
 void SpectrumVisualizer::resized()
 {
-    // The component size has changed
+    // The component size has changed - the cached background must be redrawn
+    backgroundCache = {};
     repaint();
 }
 
@@ -92,6 +108,9 @@ void SpectrumVisualizer::timerCallback()
             animationProgress = 0.0f;
             isAnimating = false;
             
+            // Nothing left to animate - don't keep waking up
+            stopTimer();
+            
             // Animation complete, set the current values to the target
             for (auto& band : filterBands)
             {
@@ -103,6 +122,7 @@ void SpectrumVisualizer::timerCallback()
         }
         
         // Repaint to show animation frame
+        responseNeedsUpdate = true;
         repaint();
     }
 }
@@ -122,7 +142,9 @@ void SpectrumVisualizer::setFrequency(float newFrequency)
         frequency = newFrequency;
         animationProgress = 0.0f;
         isAnimating = true;
+        startTimerHz(30);
         
+        responseNeedsUpdate = true;
         repaint();
     }
 }
@@ -141,7 +163,9 @@ void SpectrumVisualizer::setQFactor(float newQ)
         qFactor = newQ;
         animationProgress = 0.0f;
         isAnimating = true;
+        startTimerHz(30);
         
+        responseNeedsUpdate = true;
         repaint();
     }
 }
@@ -160,7 +184,9 @@ void SpectrumVisualizer::setGain(float newGain)
         gain = newGain;
         animationProgress = 0.0f;
         isAnimating = true;
+        startTimerHz(30);
         
+        responseNeedsUpdate = true;
         repaint();
     }
 }
@@ -188,10 +214,12 @@ void SpectrumVisualizer::addFilterBand(float freq, float q, float gain)
     qFactor = newBand.q;
     gain = newBand.gain;
     
-    // Start animation
+    // Start animation - the timer only runs while something is animating
     animationProgress = 0.0f;
     isAnimating = true;
+    startTimerHz(30);
     
+    responseNeedsUpdate = true;
     repaint();
 }
 
@@ -207,6 +235,8 @@ void SpectrumVisualizer::clearFilterBands()
     filterBands.add(defaultBand);
     
     // Reset animation
+    stopTimer();
+    isAnimating = false;
     previousBand = defaultBand;
     targetBand = defaultBand;
     
@@ -215,6 +245,7 @@ void SpectrumVisualizer::clearFilterBands()
     qFactor = defaultBand.q;
     gain = defaultBand.gain;
     
+    responseNeedsUpdate = true;
     repaint();
 }
 
@@ -236,14 +267,40 @@ float SpectrumVisualizer::gainToY(float gainDB, float height) const
     return height * (1.0f - (gainDB - minGain) / (maxGain - minGain));
 }
 
-float SpectrumVisualizer::calculateResponse(float freq)
+void SpectrumVisualizer::updateResponse(int numPoints)
 {
-    // Calculate the combined response of all filter bands at the given frequency
-    float response = 0.0f;
+    numPoints = juce::jmax(2, numPoints);
     
-    for (int i = 0; i < filterBands.size(); ++i)
+    // Rebuild the log-spaced frequency table only when the width changes
+    if ((int) responseDecibels.size() != numPoints)
     {
-        const auto& band = filterBands.getReference(i);
+        responseDecibels.assign((size_t) numPoints, 0.0f);
+        responsePhi.resize((size_t) numPoints);
+        responseNumerator.resize((size_t) numPoints);
+        responseDenominator.resize((size_t) numPoints);
+        
+        for (int i = 0; i < numPoints; ++i)
+        {
+            float freq = minFrequency * std::pow(maxFrequency / minFrequency, static_cast<float>(i) / (numPoints - 1));
+            double sinHalfW = std::sin(juce::MathConstants<double>::pi * freq / displaySampleRate);
+            
+            responsePhi[(size_t) i] = sinHalfW * sinHalfW;
+        }
+        
+        responseNeedsUpdate = true;
+    }
+    
+    if (! responseNeedsUpdate)
+        return;
+    
+    responseNeedsUpdate = false;
+    
+    std::fill(responseNumerator.begin(), responseNumerator.end(), 1.0);
+    std::fill(responseDenominator.begin(), responseDenominator.end(), 1.0);
+    
+    for (int b = 0; b < filterBands.size(); ++b)
+    {
+        const auto& band = filterBands.getReference(b);
         
         if (!band.isActive)
             continue;
@@ -251,7 +308,7 @@ float SpectrumVisualizer::calculateResponse(float freq)
         // Use current band values for the animating band, or interpolate during animation
         float bandFreq, bandQ, bandGain;
         
-        if (isAnimating && i == 0) // Use index comparison instead of address comparison
+        if (isAnimating && b == 0) // Use index comparison instead of address comparison
         {
             // Interpolate between previous and target values
             bandFreq = previousBand.frequency + animationProgress * (targetBand.frequency - previousBand.frequency);
@@ -265,30 +322,40 @@ float SpectrumVisualizer::calculateResponse(float freq)
             bandGain = band.gain;
         }
         
-        // Calculate the standard EQ formula for a peak filter (simplified)
-        float omega = (freq / bandFreq);
-        float denominator = 1.0f + (1.0f / bandQ) * omega;
+        // Peaking EQ biquad (RBJ cookbook), normalised so a0 == 1
+        double A = std::pow(10.0, bandGain / 40.0);
+        double w0 = juce::MathConstants<double>::twoPi * bandFreq / displaySampleRate;
+        double alpha = std::sin(w0) / (2.0 * bandQ);
+        double a0 = 1.0 + alpha / A;
+        
+        double b0 = (1.0 + alpha * A) / a0;
+        double b1 = -2.0 * std::cos(w0) / a0;
+        double b2 = (1.0 - alpha * A) / a0;
+        double a1 = b1;
+        double a2 = (1.0 - alpha / A) / a0;
+        
+        // |H|^2 in closed form with phi = sin^2(w/2): (n0 + n1 phi + n2 phi^2) / (d0 + d1 phi + d2 phi^2).
+        // The cos w / cos 2w form cancels catastrophically for low bands, so this stays in double.
+        const double bSum = b0 + b1 + b2, aSum = 1.0 + a1 + a2;
+        const double n0 = bSum * bSum, n1 = -4.0 * (b0 * b1 + 4.0 * b0 * b2 + b1 * b2), n2 = 16.0 * b0 * b2;
+        const double d0 = aSum * aSum, d1 = -4.0 * (a1 + 4.0 * a2 + a1 * a2),        d2 = 16.0 * a2;
+        
+        // Plain loops over contiguous arrays, so the compiler can vectorise them
+        const double* phi = responsePhi.data();
+        double* numerator = responseNumerator.data();
+        double* denominator = responseDenominator.data();
         
-        // Simplified EQ response curve formula
-        if (omega > 0.0f)
+        for (int i = 0; i < numPoints; ++i)
         {
-            float responseFactor;
-            // Different equations for boost vs cut for better visualization
-            if (bandGain >= 0)
-            {
-                // Boost
-                responseFactor = bandGain * (1.0f - 1.0f / (1.0f + std::pow(omega, 4) * std::pow(bandQ, 2)));
-            }
-            else
-            {
-                // Cut
-                responseFactor = bandGain * (1.0f / (1.0f + std::pow(omega, 2) / bandQ));
-            }
-            response += responseFactor;
+            numerator[i] *= n0 + (n1 + n2 * phi[i]) * phi[i];
+            denominator[i] *= d0 + (d1 + d2 * phi[i]) * phi[i];
         }
     }
     
-    return response;
+    // One log10 per point for the whole chain of bands
+    for (int i = 0; i < numPoints; ++i)
+        responseDecibels[(size_t) i] = static_cast<float>(10.0 * std::log10(juce::jmax(1.0e-40, responseNumerator[(size_t) i])
+                                                                            / juce::jmax(1.0e-40, responseDenominator[(size_t) i])));
 }
 
 void SpectrumVisualizer::drawResponseCurve(juce::Graphics& g, const juce::Rectangle<float>& bounds)
@@ -305,25 +372,25 @@ void SpectrumVisualizer::drawResponseCurve(juce::Graphics& g, const juce::Rectan
     // Start at the left edge at zero dB
     responsePath.startNewSubPath(bounds.getX(), bounds.getY() + zeroDB);
     
-    // Add points to the path
-    const int numPoints = 200;  // More points for smoother curve
+    // One point per pixel - the response is only recomputed when a band changes
+    const int numPoints = juce::jmax(2, static_cast<int>(width));
+    updateResponse(numPoints);
     
-    for (int i = 0; i <= numPoints; ++i)
+    // The frequency table is log-spaced, so the points are evenly spaced in x.
+    // Most of an EQ curve is flat or gently sloped, so far fewer points than
+    // pixels draw the same line
+    responseCurve.clear();
+    
+    for (int i = 0; i < numPoints; ++i)
     {
-        float ratio = static_cast<float>(i) / numPoints;
-        // Calculate frequency using logarithmic scale
-        float freq = minFrequency * std::pow(maxFrequency / minFrequency, ratio);
-        
-        // Calculate the response at this frequency
-        float response = calculateResponse(freq);
+        float x = bounds.getX() + width * static_cast<float>(i) / (numPoints - 1);
+        float y = bounds.getY() + gainToY(responseDecibels[(size_t) i], height);
         
-        // Convert to coordinates
-        float x = bounds.getX() + freqToX(freq, width);
-        float y = bounds.getY() + gainToY(response, height);
-        
-        responsePath.lineTo(x, y);
+        responseCurve.addPoint(x, y);
     }
     
+    responseCurve.appendTo(responsePath, false);
+    
     // Complete the path to form a filled shape
     responsePath.lineTo(bounds.getRight(), bounds.getY() + zeroDB);
     responsePath.closeSubPath();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "../../ThePluginLab/Source/Visualizers/CurveBuilder.h"
 
 // Forward declaration only, no impl details needed in this header
 class BlockComponent;
@@ -30,7 +31,7 @@ public:
     void paint(juce::Graphics& g) override;
     void resized() override;
     
-    // Timer callback to animate the display
+    // Timer callback to animate the display - only runs while animating
     void timerCallback() override;
     
     // Methods to update parameters from connected blocks
@@ -74,8 +75,19 @@ private:
     // Convert gain to y-coordinate
     float gainToY(float gainDB, float height) const;
     
-    // Calculate frequency response at a specific frequency
-    float calculateResponse(float freq);
+    // Recalculate the combined response of all bands at numPoints log-spaced
+    // frequencies, if the bands or the number of points changed
+    void updateResponse(int numPoints);
+    
+    // Response cache - sin^2(w/2) per point, and the summed response in dB
+    static constexpr double displaySampleRate = 48000.0;
+    std::vector<double> responsePhi;
+    std::vector<double> responseNumerator, responseDenominator;
+    std::vector<float> responseDecibels;
+    bool responseNeedsUpdate = true;
+    
+    // Shared with the plugin's visualizers, drops points within 0.25 px of the curve
+    CurveBuilder responseCurve { 0.25f };
     
     // Draw the frequency response curve
     void drawResponseCurve(juce::Graphics& g, const juce::Rectangle<float>& bounds);
@@ -90,6 +102,10 @@ private:
     juce::Path createRoundedTop(juce::Rectangle<float> bounds, float cornerSize);
     void drawBackgroundGrid(juce::Graphics& g, const juce::Rectangle<float>& bounds);
     
+    // Hexagon background, grid and scales, rendered at the physical pixel scale
+    juce::Image backgroundCache;
+    float backgroundCacheScale = 0.0f;
+    
     // Animation
     float animationProgress = 0.0f;
     FilterBand previousBand;